@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "LevelInfo.h"
+
+// Top-of-book snapshot the owning thread publishes for readers on other threads.
+struct BookView
+{
+    static constexpr std::size_t Depth = 64;
+
+    std::uint64_t orders_ {};
+    std::uint32_t bidLevels_ {};
+    std::uint32_t askLevels_ {};
+    LevelInfo bids_[Depth] {};
+    LevelInfo asks_[Depth] {};
+};
@@ -0,0 +1,219 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <format>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Usings.h"
+
+// Binary image of every resting order, so a restarted engine loads its books
+// straight back instead of replaying the whole day's journal.
+//
+// The file is a CheckpointHeader, then per book a CheckpointBook followed by
+// its bid levels (best first), its ask levels (best first), the orders of all
+// those levels in the same order, each level's orders in queue order, and the
+// expiry of each GoodTillTime order among them, in the same order. An order's
+// side and price come from its level and its queue position from its place in
+// the run, so a resting order costs 16 bytes (24 with an expiry). Every record
+// is fixed-size and 8-byte aligned, so CheckpointFile maps the file and hands
+// the records to OrderBook::Restore where they lie.
+//
+// WriteCheckpoint writes a temporary file and renames it over the old one, so
+// a crash mid-write leaves the previous checkpoint in place.
+struct CheckpointHeader
+{
+    static constexpr char Magic[8] = { 'O', 'B', 'C', 'K', 'P', 'T', 0, 0 };
+    static constexpr std::uint32_t Version = 2; // 2: GoodTillTime expiries
+
+    char magic_[8] {};
+    std::uint32_t version_ {};
+    std::uint32_t books_ {};
+    char reserved_[48] {};
+};
+static_assert(sizeof(CheckpointHeader) == 64);
+
+struct CheckpointBook
+{
+    std::uint64_t key_ {};       // the book's symbol, as SymbolKey
+    std::uint64_t applied_ {};   // journaled commands the book had applied when it was captured
+    std::uint64_t bidLevels_ {};
+    std::uint64_t askLevels_ {};
+    std::uint64_t orders_ {};
+    std::uint64_t expiries_ {};
+};
+static_assert(sizeof(CheckpointBook) == 48);
+
+struct CheckpointLevel
+{
+    Price price_ {};
+    std::uint32_t orders_ {};
+};
+static_assert(sizeof(CheckpointLevel) == 8, "Checkpoint records are part of the file format");
+
+struct CheckpointOrder
+{
+    OrderId orderId_ {};
+    Quantity quantity_ {};
+    std::uint8_t type_ {};
+    std::uint8_t reserved_[3] {};
+};
+static_assert(sizeof(CheckpointOrder) == 16, "Checkpoint records are part of the file format");
+
+// One book's records, wherever they live: in a BookCheckpoint or in a mapped file.
+struct CheckpointView
+{
+    std::span<const CheckpointLevel> bids_;
+    std::span<const CheckpointLevel> asks_;
+    std::span<const CheckpointOrder> orders_;
+    std::span<const std::int64_t> expiries_;   // nanoseconds since the Unix epoch
+};
+
+// What OrderBook::Checkpoint captures. Reusing one keeps the vectors' capacity.
+struct BookCheckpoint
+{
+    std::uint64_t key_ = 0;
+    std::uint64_t applied_ = 0;
+    std::vector<CheckpointLevel> bids_;
+    std::vector<CheckpointLevel> asks_;
+    std::vector<CheckpointOrder> orders_;
+    std::vector<std::int64_t> expiries_;
+
+    CheckpointView View() const { return CheckpointView { bids_, asks_, orders_, expiries_ }; }
+};
+
+namespace CheckpointDetail
+{
+    inline void WriteAll(int fd, const void* data, std::size_t size, const std::string& path)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            const ssize_t written = write(fd, bytes, size);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0)
+                throw std::runtime_error(std::format("Cannot write checkpoint ({}): {}.", path, std::strerror(errno)));
+            bytes += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
+}
+
+// Writes `books` to `path`, durably, replacing whatever checkpoint was there.
+inline void WriteCheckpoint(const std::string& path, std::span<const BookCheckpoint* const> books)
+{
+    const std::string temporary = path + ".tmp";
+    const int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw std::runtime_error(std::format("Cannot create checkpoint ({}): {}.", temporary, std::strerror(errno)));
+    try
+    {
+        CheckpointHeader header;
+        std::memcpy(header.magic_, CheckpointHeader::Magic, sizeof(header.magic_));
+        header.version_ = CheckpointHeader::Version;
+        header.books_ = static_cast<std::uint32_t>(books.size());
+        CheckpointDetail::WriteAll(fd, &header, sizeof(header), temporary);
+        for (const BookCheckpoint* checkpoint : books)
+        {
+            const BookCheckpoint& book = *checkpoint;
+            const CheckpointBook entry { book.key_, book.applied_, book.bids_.size(), book.asks_.size(), book.orders_.size(), book.expiries_.size() };
+            CheckpointDetail::WriteAll(fd, &entry, sizeof(entry), temporary);
+            CheckpointDetail::WriteAll(fd, book.bids_.data(), book.bids_.size() * sizeof(CheckpointLevel), temporary);
+            CheckpointDetail::WriteAll(fd, book.asks_.data(), book.asks_.size() * sizeof(CheckpointLevel), temporary);
+            CheckpointDetail::WriteAll(fd, book.orders_.data(), book.orders_.size() * sizeof(CheckpointOrder), temporary);
+            CheckpointDetail::WriteAll(fd, book.expiries_.data(), book.expiries_.size() * sizeof(std::int64_t), temporary);
+        }
+        if (fdatasync(fd) != 0)
+            throw std::runtime_error(std::format("Cannot sync checkpoint ({}): {}.", temporary, std::strerror(errno)));
+    }
+    catch (...)
+    {
+        close(fd);
+        unlink(temporary.c_str());
+        throw;
+    }
+    close(fd);
+    if (rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        const int error = errno;
+        unlink(temporary.c_str());
+        throw std::runtime_error(std::format("Cannot replace checkpoint ({}): {}.", path, std::strerror(error)));
+    }
+}
+
+// A checkpoint file mapped read-only. The views Books() hands out point into
+// the mapping and stay valid for the CheckpointFile's lifetime.
+class CheckpointFile
+{
+    public:
+        struct Book
+        {
+            std::uint64_t key_;
+            std::uint64_t applied_;
+            CheckpointView view_;
+        };
+
+        explicit CheckpointFile(const std::string& path)
+        {
+            const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) throw std::runtime_error(std::format("Cannot open checkpoint ({}): {}.", path, std::strerror(errno)));
+            struct stat info {};
+            if (fstat(fd, &info) == 0) size_ = static_cast<std::size_t>(info.st_size);
+            // Restore reads every page once, front to back: fault them in up front.
+            void* memory = size_ >= sizeof(CheckpointHeader) ? mmap(nullptr, size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0) : MAP_FAILED;
+            close(fd);
+            if (memory == MAP_FAILED) throw std::runtime_error(std::format("Checkpoint ({}) is too short or cannot be mapped.", path));
+            memory_ = static_cast<const char*>(memory);
+            try { Parse(path); }
+            catch (...)
+            {
+                munmap(const_cast<char*>(memory_), size_);
+                throw;
+            }
+        }
+        CheckpointFile(const CheckpointFile&) = delete;
+        CheckpointFile& operator=(const CheckpointFile&) = delete;
+        ~CheckpointFile() { munmap(const_cast<char*>(memory_), size_); }
+
+        std::span<const Book> Books() const { return books_; }
+
+    private:
+        const char* memory_ { nullptr };
+        std::size_t size_ { 0 };
+        std::vector<Book> books_;
+
+        template <typename Record>
+        std::span<const Record> Take(std::size_t& offset, std::uint64_t count, const std::string& path) const
+        {
+            if (count > (size_ - offset) / sizeof(Record)) throw std::runtime_error(std::format("Checkpoint ({}) is truncated.", path));
+            const auto* records = reinterpret_cast<const Record*>(memory_ + offset);
+            offset += count * sizeof(Record);
+            return { records, static_cast<std::size_t>(count) };
+        }
+
+        void Parse(const std::string& path)
+        {
+            const auto& header = *reinterpret_cast<const CheckpointHeader*>(memory_);
+            if (std::memcmp(header.magic_, CheckpointHeader::Magic, sizeof(header.magic_)) != 0 || header.version_ != CheckpointHeader::Version)
+                throw std::runtime_error(std::format("{} is not a version {} checkpoint.", path, CheckpointHeader::Version));
+
+            std::size_t offset = sizeof(CheckpointHeader);
+            for (std::uint32_t i = 0; i < header.books_; ++i)
+            {
+                const CheckpointBook& book = Take<CheckpointBook>(offset, 1, path)[0];
+                CheckpointView view;
+                view.bids_ = Take<CheckpointLevel>(offset, book.bidLevels_, path);
+                view.asks_ = Take<CheckpointLevel>(offset, book.askLevels_, path);
+                view.orders_ = Take<CheckpointOrder>(offset, book.orders_, path);
+                view.expiries_ = Take<std::int64_t>(offset, book.expiries_, path);
+                books_.push_back(Book { book.key_, book.applied_, view });
+            }
+            if (offset != size_) throw std::runtime_error(std::format("Checkpoint ({}) has trailing bytes.", path));
+        }
+};
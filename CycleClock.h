@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Timestamp source for latency measurement. On x86 it reads the time-stamp
+// counter, which is constant-rate and synchronised across cores on any recent
+// CPU, and converts ticks to nanoseconds with a rate calibrated once against
+// steady_clock. Elsewhere a tick is a steady_clock nanosecond.
+class CycleClock
+{
+    public:
+        static std::uint64_t Now()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return SteadyNanos();
+#endif
+        }
+
+        static double NanosPerTick()
+        {
+            static const double nanosPerTick = Calibrate();
+            return nanosPerTick;
+        }
+
+        static std::uint64_t ToNanos(std::uint64_t ticks) { return static_cast<std::uint64_t>(ticks * NanosPerTick()); }
+
+    private:
+        static std::uint64_t SteadyNanos()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static double Calibrate()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            const std::uint64_t nanosStart = SteadyNanos();
+            const std::uint64_t ticksStart = Now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            const std::uint64_t ticks = Now() - ticksStart;
+            const std::uint64_t nanos = SteadyNanos() - nanosStart;
+            return ticks == 0 ? 1.0 : static_cast<double>(nanos) / static_cast<double>(ticks);
+#else
+            return 1.0;
+#endif
+        }
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "Protocol.h"
+
+// Work item on the engine thread's inbound queue. Network threads post orders;
+// the book's GoodForDay timer posts an expiry so the engine stays the only writer.
+// ExpireOrders is the engine's own: it moves a book's good-till-time clock to
+// order.expiry, so the journal records exactly which orders ran out.
+enum class CommandType : uint8_t
+{
+    NewOrder,
+    CancelOrder,
+    ExpireGoodForDay,
+    ModifyOrder,
+    ExpireOrders
+};
+
+struct EngineCommand
+{
+    CommandType type;
+    NewOrderMsg order;
+};
+
+// Wire frames become commands by copying their fields into the order slot;
+// fields a frame does not carry stay zero.
+inline EngineCommand ToCommand(const NewOrderMsg& msg)
+{
+    return EngineCommand { CommandType::NewOrder, msg };
+}
+
+inline EngineCommand ToCommand(const CancelOrderMsg& msg)
+{
+    EngineCommand command {};
+    command.type = CommandType::CancelOrder;
+    command.order.type = msg.type;
+    command.order.timestamp = msg.timestamp;
+    command.order.order_id = msg.order_id;
+    std::memcpy(command.order.symbol, msg.symbol, sizeof(msg.symbol));
+    return command;
+}
+
+inline EngineCommand ToCommand(const ModifyOrderMsg& msg)
+{
+    EngineCommand command {};
+    command.type = CommandType::ModifyOrder;
+    command.order.type = msg.type;
+    command.order.timestamp = msg.timestamp;
+    command.order.order_id = msg.order_id;
+    command.order.price = msg.price;
+    command.order.quantity = msg.quantity;
+    command.order.side = msg.side;
+    std::memcpy(command.order.symbol, msg.symbol, sizeof(msg.symbol));
+    return command;
+}
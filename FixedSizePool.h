@@ -1,5 +1,17 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 
 template <typename T>
@@ -10,63 +22,581 @@ struct alignas(16) TaggedPointer
 };
 
 
+struct PoolOptions
+{
+    bool thread_cache = true; // false serves every call straight from the shared list
+    bool huge_pages = false;  // back the arena with 2 MB pages: hugetlbfs if reserved, else transparent huge pages
+    bool growable = false;    // map another chunk when the current one runs dry, instead of failing
+};
+
+struct PoolStats
+{
+    size_t capacity = 0;    // blocks across all chunks
+    size_t live = 0;        // blocks handed out and not yet returned
+    size_t high_water = 0;  // most blocks out of the shared pool at once, magazine-cached ones included
+    size_t chunks = 0;
+    uint64_t exhausted = 0; // allocate() calls that returned nullptr
+};
+
+
+// Lock-free fixed-size pool over one or more chunks of `capacity` blocks. A
+// chunk is mapped but not touched up front: blocks are carved off a bump
+// index the first time they are needed, so startup costs no page faults,
+// slots are never default-constructed, and each page is first touched (and so
+// placed) by the thread that allocates from it. A fixed pool has one chunk
+// and allocate() returns nullptr once it is used up; a growable pool maps
+// another chunk (up to MaxChunks) and never moves a live block.
+//
+// With the thread cache on (the default), every thread allocates from and
+// frees into its own magazine: a private free list popped and pushed without
+// atomics. A magazine refills from the shared list MagazineBatch blocks at a
+// time and hands MagazineBatch back once it holds twice that, one CAS per
+// batch. Blocks parked in other threads' magazines are invisible to
+// allocate(), so it can report exhaustion while up to 2 * MagazineBatch
+// blocks per other thread are still cached. A thread's magazines go back to
+// the shared list when it exits.
 template <typename T>
 class MemoryPool
 {
 private:
-    T* memoryPool_;
+    static constexpr size_t MagazineBatch = 32;
+    static constexpr size_t CacheSlots = 64;
+    static constexpr size_t MaxChunks = 64;
+
+    struct Magazine
+    {
+        T* head = nullptr;
+        std::atomic<size_t> count { 0 }; // written by the owner only; atomic so Stats() can read it
+        std::thread::id owner;
+
+        size_t Count() const { return count.load(std::memory_order_relaxed); }
+        void SetCount(size_t value) { count.store(value, std::memory_order_relaxed); }
+    };
+
+    struct Chunk
+    {
+        T* blocks = nullptr;
+        size_t bytes = 0;
+        std::atomic<size_t> fresh { 0 }; // blocks below this index have been carved off
+    };
+
+    // This thread's magazines. `recent` is direct-mapped on the pool id and
+    // is all allocate() and deallocate() look at. Behind it, `slots` is a
+    // linear-probed table holding every pool the thread has used, so two
+    // pools whose ids share a recent slot only swap entries there; neither
+    // magazine goes back to its pool. Ids are never reused, so an entry left
+    // behind by a destroyed pool never matches; the table drops such entries
+    // when it next fills up.
+    struct ThreadCache
+    {
+        struct Slot
+        {
+            uint64_t pool_id = 0; // 0 marks a free slot; ids start at 1
+            MemoryPool* pool = nullptr;
+            Magazine* magazine = nullptr;
+        };
+        Slot recent[CacheSlots];
+        std::vector<Slot> slots = std::vector<Slot>(CacheSlots);
+        size_t used = 0;
+
+        ThreadCache() { LivePools(); } // constructed first, so destroyed after this cache
+        ~ThreadCache() { for (auto& slot : slots) Release(slot); }
+
+        Slot* Find(uint64_t pool_id)
+        {
+            const size_t mask = slots.size() - 1;
+            for (size_t index = pool_id & mask; ; index = (index + 1) & mask)
+            {
+                if (slots[index].pool_id == pool_id) return &slots[index];
+                if (slots[index].pool_id == 0) return nullptr;
+            }
+        }
+
+        void Insert(const Slot& slot)
+        {
+            if ((used + 1) * 2 > slots.size()) Rebuild();
+            Place(slot);
+            ++used;
+        }
+
+        void Place(const Slot& slot)
+        {
+            const size_t mask = slots.size() - 1;
+            size_t index = slot.pool_id & mask;
+            while (slots[index].pool_id != 0) index = (index + 1) & mask;
+            slots[index] = slot;
+        }
+
+        // Keeps the live pools' entries, doubling the table while they would still fill half of it.
+        void Rebuild()
+        {
+            std::vector<Slot> kept;
+            {
+                auto& live = LivePools();
+                std::scoped_lock lock { live.mutex };
+                for (const auto& slot : slots)
+                {
+                    if (slot.pool_id != 0 && std::find(live.ids.begin(), live.ids.end(), slot.pool_id) != live.ids.end())
+                        kept.push_back(slot);
+                }
+            }
+            size_t size = slots.size();
+            while ((kept.size() + 1) * 2 > size) size *= 2;
+            slots.assign(size, Slot {});
+            used = kept.size();
+            for (const auto& slot : kept) Place(slot);
+        }
+    };
+
+    struct LivePoolSet
+    {
+        std::mutex mutex;
+        std::vector<uint64_t> ids;
+    };
+    static LivePoolSet& LivePools()
+    {
+        static LivePoolSet live;
+        return live;
+    }
+    static inline std::atomic<uint64_t> next_id_ { 1 };
+
+    std::atomic<Chunk*> chunks_[MaxChunks] {};
+    std::atomic<size_t> chunk_slots_ { 0 };   // chunks_ entries ever used; released chunks leave holes
+    std::atomic<Chunk*> current_ { nullptr }; // the chunk being carved
     std::atomic<TaggedPointer<T>> head_;
-    size_t capacity;
+    size_t capacity; // per chunk
+    bool thread_cache_;
+    bool huge_pages_;
+    bool growable_;
+    bool huge_tlb_ = false;
+    int numa_node_ = -1;
+    uint64_t id_;
+    std::mutex grow_mutex_;
+    std::mutex magazines_mutex_;
+    std::vector<std::unique_ptr<Magazine>> magazines_;
 
-public:
-    MemoryPool(size_t capacity)
+    // Telemetry; on the magazine path these only move once per batch.
+    std::atomic<size_t> carved_ { 0 };
+    std::atomic<size_t> shared_free_ { 0 };
+    std::atomic<size_t> high_water_ { 0 };
+    std::atomic<uint64_t> exhausted_ { 0 };
+
+    static T*& Next(T* block) { return *reinterpret_cast<T**>(block); }
+
+    // Index of the chunk holding `block`, or `slots` if none does.
+    size_t SlotOf(const T* block, size_t slots) const
     {
-        this->capacity = capacity;
-        memoryPool_ = new T[capacity];
-        for (size_t i = 0; i < capacity - 1; ++i)
+        for (size_t i = 0; i < slots; ++i)
         {
-            T* current_block = &memoryPool_[i];
-            T* next_block = &memoryPool_[i+1];
-            T** pointer_to_next = reinterpret_cast<T**>(current_block);
-            *pointer_to_next = next_block;
+            Chunk* chunk = chunks_[i].load(std::memory_order_acquire);
+            if (chunk != nullptr && block >= chunk->blocks && block < chunk->blocks + capacity) return i;
         }
-        T** pointer_to_last = reinterpret_cast<T**>(&memoryPool_[capacity-1]);
-        *pointer_to_last = nullptr;
-        head_ = TaggedPointer<T>{&memoryPool_[0], 0};
+        return slots;
     }
-    ~MemoryPool()
+    bool Owns(const T* block) const
     {
-        delete[] memoryPool_;
+        const size_t slots = chunk_slots_.load(std::memory_order_acquire);
+        return SlotOf(block, slots) != slots;
     }
-    T* allocate()
+
+    Chunk* MapChunk()
+    {
+        auto chunk = std::make_unique<Chunk>();
+        chunk->bytes = capacity * sizeof(T);
+#ifdef __linux__
+        constexpr size_t HugePage = size_t(2) << 20;
+        void* arena = MAP_FAILED;
+        if (huge_pages_)
+        {
+            // Reserved up front, so this fails (rather than faulting later) without enough hugetlbfs pages.
+            chunk->bytes = (chunk->bytes + HugePage - 1) / HugePage * HugePage;
+            arena = mmap(nullptr, chunk->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            huge_tlb_ = arena != MAP_FAILED;
+        }
+        if (arena == MAP_FAILED)
+            arena = mmap(nullptr, chunk->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (arena == MAP_FAILED) throw std::bad_alloc();
+        if (huge_pages_ && !huge_tlb_) madvise(arena, chunk->bytes, MADV_HUGEPAGE);
+        chunk->blocks = static_cast<T*>(arena);
+        if (numa_node_ >= 0) BindChunk(*chunk, numa_node_);
+#else
+        chunk->blocks = static_cast<T*>(::operator new(chunk->bytes, std::align_val_t { alignof(T) }));
+#endif
+        return chunk.release();
+    }
+    static void UnmapChunk(Chunk* chunk)
+    {
+#ifdef __linux__
+        munmap(chunk->blocks, chunk->bytes);
+#else
+        ::operator delete(chunk->blocks, std::align_val_t { alignof(T) });
+#endif
+        delete chunk;
+    }
+    static bool BindChunk(Chunk& chunk, int node)
+    {
+#ifdef __linux__
+        constexpr int MpolPreferred = 1;
+        unsigned long mask = 1ul << node;
+        return syscall(SYS_mbind, chunk.blocks, chunk.bytes, MpolPreferred, &mask, sizeof(mask) * 8 + 1, 0) == 0;
+#else
+        (void)chunk;
+        (void)node;
+        return false;
+#endif
+    }
+
+    // Installs a new current chunk unless another thread already replaced `seen`.
+    bool Grow(Chunk* seen)
+    {
+        std::scoped_lock lock { grow_mutex_ };
+        if (current_.load(std::memory_order_acquire) != seen) return true;
+
+        const size_t slots = chunk_slots_.load(std::memory_order_relaxed);
+        size_t slot = 0;
+        while (slot < slots && chunks_[slot].load(std::memory_order_relaxed) != nullptr) ++slot;
+        if (slot == MaxChunks) return false;
+
+        Chunk* chunk;
+        try { chunk = MapChunk(); }
+        catch (const std::bad_alloc&) { return false; }
+        chunks_[slot].store(chunk, std::memory_order_release);
+        if (slot == slots) chunk_slots_.store(slots + 1, std::memory_order_release);
+        current_.store(chunk, std::memory_order_release);
+        return true;
+    }
+
+    // Blocks out of the shared pool. The two counters are read separately, so clamp a torn read at zero.
+    size_t OutOfShared() const
+    {
+        const size_t free_blocks = shared_free_.load(std::memory_order_relaxed);
+        const size_t carved = carved_.load(std::memory_order_relaxed);
+        return carved > free_blocks ? carved - free_blocks : 0;
+    }
+
+    void NoteInUse()
+    {
+        const size_t in_use = OutOfShared();
+        size_t peak = high_water_.load(std::memory_order_relaxed);
+        while (in_use > peak && !high_water_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {}
+    }
+
+    // Returns a slot's magazine to its pool if the pool is still alive.
+    static void Release(typename ThreadCache::Slot& slot)
+    {
+        if (slot.magazine != nullptr)
+        {
+            auto& live = LivePools();
+            std::scoped_lock lock { live.mutex };
+            if (std::find(live.ids.begin(), live.ids.end(), slot.pool_id) != live.ids.end() && slot.magazine->Count() > 0)
+                slot.pool->Spill(*slot.magazine, slot.magazine->Count());
+        }
+        slot = {};
+    }
+
+    Magazine& LocalMagazine()
+    {
+        thread_local ThreadCache cache;
+        auto& slot = cache.recent[id_ % CacheSlots];
+        if (slot.pool_id != id_) [[unlikely]] slot = Lookup(cache);
+        return *slot.magazine;
+    }
+
+    typename ThreadCache::Slot Lookup(ThreadCache& cache)
+    {
+        if (const auto* slot = cache.Find(id_)) return *slot;
+        return Attach(cache);
+    }
+
+    // First use of this pool on this thread.
+    typename ThreadCache::Slot Attach(ThreadCache& cache)
+    {
+        Magazine* magazine;
+        {
+            std::scoped_lock lock { magazines_mutex_ };
+            const auto self = std::this_thread::get_id();
+            auto found = std::find_if(magazines_.begin(), magazines_.end(), [&](const auto& magazine) { return magazine->owner == self; });
+            if (found == magazines_.end())
+            {
+                magazines_.push_back(std::make_unique<Magazine>());
+                magazines_.back()->owner = self;
+                found = magazines_.end() - 1;
+            }
+            magazine = found->get();
+        }
+        cache.Insert({ id_, this, magazine });
+        return { id_, this, magazine };
+    }
+
+    // Claims up to `wanted` never-used blocks, growing the pool if it may;
+    // returns the first and sets `count`.
+    T* Carve(size_t wanted, size_t& count)
+    {
+        while (true)
+        {
+            Chunk* chunk = current_.load(std::memory_order_acquire);
+            size_t first = chunk->fresh.load(std::memory_order_relaxed);
+            while (first < capacity)
+            {
+                count = std::min(wanted, capacity - first);
+                if (chunk->fresh.compare_exchange_weak(first, first + count, std::memory_order_relaxed))
+                {
+                    carved_.fetch_add(count, std::memory_order_relaxed);
+                    return &chunk->blocks[first];
+                }
+            }
+            if (!growable_ || !Grow(chunk)) return nullptr;
+        }
+    }
+
+    bool RefillFresh(Magazine& magazine)
+    {
+        size_t count;
+        T* first = Carve(MagazineBatch, count);
+        if (first == nullptr) return false;
+        for (size_t i = 0; i + 1 < count; ++i) Next(&first[i]) = &first[i + 1];
+        magazine.head = first;
+        magazine.SetCount(count);
+        return true;
+    }
+
+    // Moves up to MagazineBatch blocks from the shared list into the magazine,
+    // or fresh ones from a chunk once the list is empty.
+    bool Refill(Magazine& magazine)
+    {
+        TaggedPointer<T> expected = head_.load();
+        T* last;
+        T* rest;
+        size_t taken;
+        do
+        {
+            if (expected.ptr == nullptr) return RefillFresh(magazine);
+            last = expected.ptr;
+            taken = 1;
+            // Another thread may pop these blocks mid-walk and overwrite their links.
+            // Such a read is stale but stays inside the pool, and the CAS then fails.
+            while (taken < MagazineBatch)
+            {
+                T* next = Next(last);
+                if (!Owns(next)) break;
+                last = next;
+                ++taken;
+            }
+            rest = Next(last);
+        }
+        while (!head_.compare_exchange_weak(expected, TaggedPointer<T>{rest, expected.version + 1}));
+
+        shared_free_.fetch_sub(taken, std::memory_order_relaxed);
+        magazine.head = expected.ptr;
+        magazine.SetCount(taken);
+        return true;
+    }
+
+    // Pushes the first `count` blocks of the magazine onto the shared list.
+    void Spill(Magazine& magazine, size_t count)
+    {
+        T* first = magazine.head;
+        T* last = first;
+        for (size_t i = 1; i < count; ++i) last = Next(last);
+        magazine.head = Next(last);
+        magazine.SetCount(magazine.Count() - count);
+
+        TaggedPointer<T> expected = head_.load();
+        do
+        {
+            Next(last) = expected.ptr;
+        }
+        while (!head_.compare_exchange_weak(expected, TaggedPointer<T>{first, expected.version + 1}));
+        shared_free_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    T* AllocateShared()
     {
         TaggedPointer<T> expected = head_.load();
         T* next_block;
         do
         {
-            if (expected.ptr == nullptr) return nullptr;
+            if (expected.ptr == nullptr)
+            {
+                size_t count;
+                return Carve(1, count);
+            }
             T** pointer_to_next = reinterpret_cast<T**>(expected.ptr);
             next_block = *pointer_to_next;
 
         }
         while(!head_.compare_exchange_weak(expected, TaggedPointer<T>{next_block, expected.version + 1}));
+        shared_free_.fetch_sub(1, std::memory_order_relaxed);
         return expected.ptr;
     }
-    void deallocate(T* memory)
+    void DeallocateShared(T* memory)
     {
-        if (memory == nullptr) return;
         TaggedPointer<T> expected = head_.load();
         T** new_block = reinterpret_cast<T**>(memory);
-        do 
+        do
         {
             *new_block = expected.ptr;
         }
         while (!head_.compare_exchange_weak(expected, TaggedPointer<T>{memory, expected.version + 1}));
+        shared_free_.fetch_add(1, std::memory_order_relaxed);
     }
-};
 
+public:
+    MemoryPool(size_t capacity, PoolOptions options = {})
+    {
+        static_assert(sizeof(T) >= sizeof(T*), "free blocks hold the next-block link");
+        this->capacity = capacity;
+        thread_cache_ = options.thread_cache;
+        huge_pages_ = options.huge_pages;
+        growable_ = options.growable;
+        id_ = next_id_.fetch_add(1, std::memory_order_relaxed);
+        head_ = TaggedPointer<T>{nullptr, 0};
+
+        Chunk* chunk = MapChunk();
+        chunks_[0].store(chunk, std::memory_order_relaxed);
+        chunk_slots_.store(1, std::memory_order_relaxed);
+        current_.store(chunk, std::memory_order_release);
+
+        auto& live = LivePools();
+        std::scoped_lock lock { live.mutex };
+        live.ids.push_back(id_);
+    }
+    ~MemoryPool()
+    {
+        {
+            auto& live = LivePools();
+            std::scoped_lock lock { live.mutex };
+            live.ids.erase(std::find(live.ids.begin(), live.ids.end(), id_));
+        }
+        for (auto& slot : chunks_)
+        {
+            if (Chunk* chunk = slot.load(std::memory_order_relaxed)) UnmapChunk(chunk);
+        }
+    }
+    // Blocks per chunk, which is the whole capacity of a fixed pool.
+    size_t Capacity() const { return capacity; }
+    bool UsesHugeTlb() const { return huge_tlb_; }
+
+    // Prefers NUMA node `node` for every page not yet touched, including those
+    // of chunks mapped later, so call it before the owning thread starts
+    // allocating. False if the kernel refused.
+    bool BindToNode(int node)
+    {
+        if (node < 0 || node >= 64) return false;
+        std::scoped_lock lock { grow_mutex_ };
+        numa_node_ = node;
+        bool bound = true;
+        for (auto& slot : chunks_)
+        {
+            if (Chunk* chunk = slot.load(std::memory_order_relaxed)) bound = BindChunk(*chunk, node) && bound;
+        }
+        return bound;
+    }
+
+    PoolStats Stats()
+    {
+        PoolStats stats;
+        size_t cached = 0;
+        {
+            std::scoped_lock lock { magazines_mutex_ };
+            for (const auto& magazine : magazines_) cached += magazine->Count();
+        }
+        for (auto& slot : chunks_) stats.chunks += slot.load(std::memory_order_acquire) != nullptr;
+        stats.capacity = stats.chunks * capacity;
+        const size_t out = OutOfShared();
+        stats.live = out > cached ? out - cached : 0;
+        stats.high_water = std::max(high_water_.load(std::memory_order_relaxed), out);
+        stats.exhausted = exhausted_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // Unmaps every chunk, other than the one being carved, whose blocks are
+    // all free, and returns how many went. Every thread's cached blocks are
+    // pulled back first, so no other thread may use the pool meanwhile.
+    size_t ReleaseIdleChunks()
+    {
+        std::scoped_lock lock { grow_mutex_, magazines_mutex_ };
+        for (const auto& magazine : magazines_)
+        {
+            if (magazine->Count() > 0) Spill(*magazine, magazine->Count());
+        }
+
+        const size_t slots = chunk_slots_.load(std::memory_order_relaxed);
+        std::vector<size_t> free_blocks(slots + 1, 0);
+        for (T* block = head_.load().ptr; block != nullptr; block = Next(block)) ++free_blocks[SlotOf(block, slots)];
+
+        std::vector<bool> idle(slots + 1, false);
+        size_t released = 0;
+        for (size_t i = 0; i < slots; ++i)
+        {
+            Chunk* chunk = chunks_[i].load(std::memory_order_relaxed);
+            idle[i] = chunk != nullptr && chunk != current_.load(std::memory_order_relaxed)
+                && free_blocks[i] == chunk->fresh.load(std::memory_order_relaxed);
+            released += idle[i];
+        }
+        if (released == 0) return 0;
 
+        // Relink the shared list without the idle chunks' blocks, then unmap them.
+        T* kept = nullptr;
+        size_t kept_count = 0;
+        for (T* block = head_.load().ptr; block != nullptr; )
+        {
+            T* next = Next(block);
+            if (!idle[SlotOf(block, slots)])
+            {
+                Next(block) = kept;
+                kept = block;
+                ++kept_count;
+            }
+            block = next;
+        }
+        head_.store(TaggedPointer<T>{kept, head_.load().version + 1});
+        carved_.fetch_sub(shared_free_.load(std::memory_order_relaxed) - kept_count, std::memory_order_relaxed);
+        shared_free_.store(kept_count, std::memory_order_relaxed);
 
+        for (size_t i = 0; i < slots; ++i)
+        {
+            if (idle[i]) UnmapChunk(chunks_[i].exchange(nullptr, std::memory_order_relaxed));
+        }
+        return released;
+    }
 
+    T* allocate()
+    {
+        if (!thread_cache_)
+        {
+            T* block = AllocateShared();
+            if (block == nullptr) exhausted_.fetch_add(1, std::memory_order_relaxed);
+            else NoteInUse();
+            return block;
+        }
 
+        Magazine& magazine = LocalMagazine();
+        size_t count = magazine.Count();
+        if (count == 0)
+        {
+            if (!Refill(magazine))
+            {
+                exhausted_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            NoteInUse();
+            count = magazine.Count();
+        }
+        T* block = magazine.head;
+        magazine.head = Next(block);
+        magazine.SetCount(count - 1);
+        return block;
+    }
+    void deallocate(T* memory)
+    {
+        if (memory == nullptr) return;
+        if (!thread_cache_) { DeallocateShared(memory); return; }
 
+        Magazine& magazine = LocalMagazine();
+        if (magazine.Count() == 2 * MagazineBatch) Spill(magazine, MagazineBatch);
+        Next(memory) = magazine.head;
+        magazine.head = memory;
+        magazine.SetCount(magazine.Count() + 1);
+    }
+};
@@ -0,0 +1,202 @@
+#pragma once
+#include <bit>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <format>
+
+// Open-addressing hash map over one flat slot array, using Robin Hood linear
+// probing: a key that is further from its home slot takes over the slot of one
+// that is closer. Keys in a run therefore stay ordered by home slot, so a miss
+// stops as soon as it meets a key closer to home than itself. Deletion shifts
+// the rest of the run back instead of leaving tombstones, and that shift stops
+// at the first key already sitting in its home slot. The low 32 bits of a key
+// hash to themselves: order ids grow monotonically and prices are dense, so
+// consecutive keys sit in their own home slots. The high bits are mixed in as a
+// scattered offset, so id spaces that differ only there (one per client session,
+// say) land in different parts of the table instead of piling onto the same
+// slots. One key value (EmptyKey) is reserved to mark free slots. The table only
+// reallocates when it outgrows its reservation.
+template <typename Key, typename Value, Key EmptyKey = std::numeric_limits<Key>::max()>
+class FlatHashMap
+{
+    public:
+        struct Slot
+        {
+            Key first { EmptyKey };
+            Value second {};
+        };
+
+        class iterator
+        {
+            public:
+                iterator(Slot* slot, Slot* end): slot_ { slot }, end_ { end } { Skip(); }
+
+                Slot& operator*() const { return *slot_; }
+                Slot* operator->() const { return slot_; }
+                iterator& operator++() { ++slot_; Skip(); return *this; }
+                bool operator==(const iterator& other) const { return slot_ == other.slot_; }
+
+            private:
+                Slot* slot_;
+                Slot* end_;
+
+                void Skip() { while (slot_ != end_ && slot_->first == EmptyKey) ++slot_; }
+        };
+
+        class const_iterator
+        {
+            public:
+                const_iterator(const Slot* slot, const Slot* end): slot_ { slot }, end_ { end } { Skip(); }
+
+                const Slot& operator*() const { return *slot_; }
+                const Slot* operator->() const { return slot_; }
+                const_iterator& operator++() { ++slot_; Skip(); return *this; }
+                bool operator==(const const_iterator& other) const { return slot_ == other.slot_; }
+
+            private:
+                const Slot* slot_;
+                const Slot* end_;
+
+                void Skip() { while (slot_ != end_ && slot_->first == EmptyKey) ++slot_; }
+        };
+
+        explicit FlatHashMap(std::size_t expected = 16) { reserve(expected); }
+
+        std::size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        std::size_t capacity() const { return slots_.size(); }
+
+        iterator begin() { return iterator { slots_.data(), slots_.data() + slots_.size() }; }
+        iterator end() { return iterator { slots_.data() + slots_.size(), slots_.data() + slots_.size() }; }
+        const_iterator begin() const { return const_iterator { slots_.data(), slots_.data() + slots_.size() }; }
+        const_iterator end() const { return const_iterator { slots_.data() + slots_.size(), slots_.data() + slots_.size() }; }
+
+        // Sizes the table so that `expected` live keys stay under the 3/4 load factor.
+        void reserve(std::size_t expected)
+        {
+            const std::size_t wanted = std::bit_ceil(std::max<std::size_t>(16, expected + expected / 3 + 1));
+            if (wanted > slots_.size()) Rehash(wanted);
+        }
+
+        Value* find(Key key)
+        {
+            const std::size_t index = FindIndex(key);
+            return index == npos ? nullptr : &slots_[index].second;
+        }
+        const Value* find(Key key) const { return const_cast<FlatHashMap*>(this)->find(key); }
+
+        bool contains(Key key) const { return find(key) != nullptr; }
+
+        // Starts pulling `key`'s home slot into cache, for bulk loops that know
+        // their keys a few iterations ahead.
+        void prefetch(Key key) const { __builtin_prefetch(&slots_[Home(key)]); }
+
+        Value& at(Key key)
+        {
+            if (Value* value = find(key)) return *value;
+            throw std::out_of_range(std::format("Key ({}) is not in the map.", key));
+        }
+        const Value& at(Key key) const { return const_cast<FlatHashMap*>(this)->at(key); }
+
+        Value& operator[](Key key) { return *Emplace(key, Value {}).first; }
+
+        std::pair<Value*, bool> insert(const Slot& entry) { return Emplace(entry.first, entry.second); }
+
+        std::size_t erase(Key key)
+        {
+            std::size_t hole = FindIndex(key);
+            if (hole == npos) return 0;
+
+            for (std::size_t index = Next(hole); slots_[index].first != EmptyKey && Distance(index) > 0; index = Next(index))
+            {
+                slots_[hole] = slots_[index];
+                hole = index;
+            }
+            slots_[hole] = Slot {};
+            --size_;
+            return 1;
+        }
+
+        void clear()
+        {
+            for (auto& slot : slots_) slot = Slot {};
+            size_ = 0;
+        }
+
+    private:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        std::vector<Slot> slots_;
+        std::size_t mask_ {};
+        std::size_t size_ {};
+
+        std::size_t Home(Key key) const
+        {
+            const std::uint64_t bits = static_cast<std::uint64_t>(key);
+            return static_cast<std::size_t>(bits + (((bits >> 32) * 0x9E3779B97F4A7C15ull) >> 32)) & mask_;
+        }
+        std::size_t Next(std::size_t index) const { return (index + 1) & mask_; }
+
+        std::size_t Distance(std::size_t index) const { return (index - Home(slots_[index].first)) & mask_; }
+
+        // EmptyKey is never stored, and would otherwise match the first free slot.
+        std::size_t FindIndex(Key key) const
+        {
+            if (key == EmptyKey) return npos;
+            std::size_t index = Home(key);
+            for (std::size_t distance = 0; ; ++distance, index = Next(index))
+            {
+                if (slots_[index].first == key) return index;
+                if (slots_[index].first == EmptyKey || Distance(index) < distance) return npos;
+            }
+        }
+
+        std::pair<Value*, bool> Emplace(Key key, const Value& value)
+        {
+            if (key == EmptyKey)
+                throw std::invalid_argument(std::format("Key ({}) is reserved as the empty marker.", key));
+            if (Value* existing = find(key)) return { existing, false };
+            if ((size_ + 1) * 4 > slots_.size() * 3) Rehash(slots_.size() * 2);
+
+            ++size_;
+            return { &Place(Slot { key, value })->second, true };
+        }
+
+        // Robin Hood insert of a key known to be absent; returns where it landed.
+        Slot* Place(Slot slot)
+        {
+            Slot* placed = nullptr;
+            std::size_t index = Home(slot.first);
+            for (std::size_t distance = 0; ; ++distance, index = Next(index))
+            {
+                if (slots_[index].first == EmptyKey)
+                {
+                    slots_[index] = slot;
+                    return placed != nullptr ? placed : &slots_[index];
+                }
+                if (Distance(index) < distance)
+                {
+                    std::swap(slot, slots_[index]);
+                    if (placed == nullptr) placed = &slots_[index];
+                    // The evicted key continues probing from its own distance.
+                    distance = (index - Home(slot.first)) & mask_;
+                }
+            }
+        }
+
+        void Rehash(std::size_t capacity)
+        {
+            std::vector<Slot> slots(capacity);
+            slots.swap(slots_);
+            mask_ = capacity - 1;
+            for (const auto& slot : slots)
+            {
+                if (slot.first != EmptyKey) Place(slot);
+            }
+        }
+};
@@ -0,0 +1,355 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <format>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "EngineCommand.h"
+#include "SpscRing.h"
+
+// Write-ahead journal of every command the engine applies, so a restarted
+// engine can rebuild its books by replaying it (ReplayJournal).
+//
+// The file is a JournalHeader followed by fixed-size JournalRecords, numbered
+// from 1. It is pre-allocated and memory-mapped, and only the JournalWriter's
+// own thread touches the mapping: engine threads hand it commands through SPSC
+// rings and never wait on the disk. The writer drains whatever has arrived,
+// appends it, and makes the whole group durable with one msync (group commit);
+// commands that arrive meanwhile form the next group.
+//
+// A record is valid if it carries the next sequence number and its checksum
+// matches, so replay stops cleanly at a torn or never-written tail.
+struct JournalHeader
+{
+    static constexpr char Magic[8] = { 'O', 'B', 'J', 'R', 'N', 'L', 0, 0 };
+    static constexpr std::uint32_t Version = 2; // 2: NewOrderMsg carries an expiry
+
+    char magic_[8] {};
+    std::uint32_t version_ {};
+    std::uint32_t recordSize_ {};
+    char reserved_[48] {};
+};
+static_assert(sizeof(JournalHeader) == 64);
+
+struct JournalRecord
+{
+    std::uint64_t sequence_ {};
+    std::uint32_t checksum_ {};
+    EngineCommand command_ {};
+};
+static_assert(sizeof(JournalRecord) == 56, "Journal records are part of the file format");
+
+// Over the sequence number and the command, eight bytes at a time: one
+// multiply-xorshift round per word, so the writer spends a few nanoseconds
+// per record on it. It only has to catch torn writes, not adversaries.
+inline std::uint32_t JournalChecksum(const JournalRecord& record)
+{
+    constexpr std::size_t words = sizeof(EngineCommand) / sizeof(std::uint64_t);
+    std::uint64_t tail[2] = {};
+    std::memcpy(tail, reinterpret_cast<const char*>(&record.command_) + words * sizeof(std::uint64_t), sizeof(EngineCommand) % sizeof(std::uint64_t));
+
+    std::uint64_t hash = record.sequence_ ^ 0x9E3779B97F4A7C15ull;
+    auto mix = [&hash](std::uint64_t word)
+    {
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    };
+    for (std::size_t i = 0; i < words; ++i)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, reinterpret_cast<const char*>(&record.command_) + i * sizeof(word), sizeof(word));
+        mix(word);
+    }
+    mix(tail[0]);
+    return static_cast<std::uint32_t>(hash);
+}
+
+// Hands every valid record's command to `handler`, oldest first, and returns how
+// many there were. A missing or empty file is an empty journal; a file that is
+// not a journal throws rather than being overwritten later.
+template <typename Handler>
+std::uint64_t ReplayJournal(const std::string& path, Handler&& handler)
+{
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (errno == ENOENT) return 0;
+        throw std::runtime_error(std::format("Cannot open journal ({}): {}.", path, std::strerror(errno)));
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return 0;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* memory = size >= sizeof(JournalHeader) ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED) throw std::runtime_error(std::format("Journal ({}) is too short or cannot be mapped.", path));
+    madvise(memory, size, MADV_SEQUENTIAL);
+
+    const auto* header = static_cast<const JournalHeader*>(memory);
+    if (std::memcmp(header->magic_, JournalHeader::Magic, sizeof(header->magic_)) != 0 || header->version_ != JournalHeader::Version ||
+        header->recordSize_ != sizeof(JournalRecord))
+    {
+        munmap(memory, size);
+        throw std::runtime_error(std::format("{} is not a version {} journal.", path, JournalHeader::Version));
+    }
+
+    const auto* records = reinterpret_cast<const JournalRecord*>(header + 1);
+    const std::size_t capacity = (size - sizeof(JournalHeader)) / sizeof(JournalRecord);
+    std::uint64_t count = 0;
+    try
+    {
+        for (; count < capacity; ++count)
+        {
+            const JournalRecord& record = records[count];
+            if (record.sequence_ != count + 1 || record.checksum_ != JournalChecksum(record)) break;
+            handler(record.command_);
+        }
+    }
+    catch (...)
+    {
+        munmap(memory, size);
+        throw;
+    }
+    munmap(memory, size);
+    return count;
+}
+
+class JournalWriter
+{
+    public:
+        static constexpr std::size_t MaxProducers = 64;
+        using Rings = SpscRingSet<EngineCommand, 16384, MaxProducers>;
+
+        // Appends after the first `records` records of the file at `path` (what
+        // ReplayJournal found valid), dropping anything past them; 0 starts a
+        // new journal. `initialRecords` is pre-allocated, doubling when full.
+        JournalWriter(std::string path, std::uint64_t records, std::size_t initialRecords = std::size_t { 1 } << 20):
+        path_ { std::move(path) }, written_ { records }, committed_ { records }, posted_ { records }
+        {
+            fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd_ < 0) throw std::runtime_error(std::format("Cannot open journal ({}): {}.", path_, std::strerror(errno)));
+            try
+            {
+                // Truncating first means stale records past the valid prefix can never reappear after a crash.
+                if (ftruncate(fd_, static_cast<off_t>(Offset(records))) != 0)
+                    throw std::runtime_error(std::format("Cannot truncate journal ({}): {}.", path_, std::strerror(errno)));
+                Map(std::max<std::uint64_t>(initialRecords, records * 2));
+                if (records == 0)
+                {
+                    JournalHeader& header = *reinterpret_cast<JournalHeader*>(memory_);
+                    std::memcpy(header.magic_, JournalHeader::Magic, sizeof(header.magic_));
+                    header.version_ = JournalHeader::Version;
+                    header.recordSize_ = sizeof(JournalRecord);
+                }
+                Sync(Offset(records));
+                durable_.store(records, std::memory_order_relaxed);
+            }
+            catch (...)
+            {
+                if (memory_ != nullptr) munmap(memory_, Offset(capacity_));
+                close(fd_);
+                throw;
+            }
+        }
+        JournalWriter(const JournalWriter&) = delete;
+        JournalWriter& operator=(const JournalWriter&) = delete;
+
+        ~JournalWriter()
+        {
+            Stop();
+            munmap(memory_, Offset(capacity_));
+            close(fd_);
+        }
+
+        // Producers Acquire a ring here (through JournalProducer) before Start or while running.
+        Rings& Inbound() { return rings_; }
+
+        void Start() { thread_ = std::thread([this]() { Run(); }); }
+
+        // Appends and commits everything producers have pushed, then returns.
+        void Stop()
+        {
+            running_.store(false, std::memory_order_release);
+            if (thread_.joinable()) thread_.join();
+        }
+
+        // Records appended since this writer opened the file, and the highest sequence number on disk.
+        std::uint64_t Appended() const { return appended_.load(std::memory_order_relaxed); }
+        std::uint64_t Durable() const { return durable_.load(std::memory_order_acquire); }
+        std::uint64_t Commits() const { return commits_.load(std::memory_order_relaxed); }
+        // At least the sequence number of every record pushed so far (producers count a
+        // batch before pushing it). Once Durable() reaches a value read here, everything
+        // pushed before the read is on disk.
+        std::uint64_t Posted() const { return posted_.load(std::memory_order_acquire); }
+        const std::string& Path() const { return path_; }
+
+        // Set once an append or commit has failed; the writer then discards what
+        // producers push, so they never block, and Error() says what happened.
+        bool Failed() const { return failed_.load(std::memory_order_acquire); }
+        const std::string& Error() const { return error_; }
+
+    private:
+        friend class JournalProducer;
+
+        static constexpr std::size_t drain_batch = 256;
+        static constexpr std::uint64_t max_group = 65536; // records per commit under sustained load
+
+        std::string path_;
+        int fd_ { -1 };
+        char* memory_ { nullptr };
+        std::uint64_t capacity_ { 0 };  // records the mapping holds
+        std::uint64_t written_;         // records in the mapping
+        std::uint64_t committed_;       // records msync has made durable
+        std::size_t synced_ { 0 };      // bytes msync has made durable
+        Rings rings_;
+        std::atomic<bool> running_ { true };
+        std::atomic<std::uint64_t> posted_;
+        std::atomic<std::uint64_t> appended_ { 0 };
+        std::atomic<std::uint64_t> durable_ { 0 };
+        std::atomic<std::uint64_t> commits_ { 0 };
+        std::atomic<bool> failed_ { false };
+        std::string error_;
+        std::thread thread_;
+
+        static std::size_t Offset(std::uint64_t records) { return sizeof(JournalHeader) + records * sizeof(JournalRecord); }
+
+        void Run()
+        {
+            std::array<EngineCommand, drain_batch> batch;
+            try
+            {
+                while (true)
+                {
+                    const bool stopping = !running_.load(std::memory_order_acquire);
+                    // The group is whatever arrived while the previous commit was on disk.
+                    while (written_ - committed_ < max_group)
+                    {
+                        if (rings_.Drain(batch.data(), batch.size(), [this](const EngineCommand& command) { Append(command); }) == 0) break;
+                    }
+                    if (written_ > committed_) Commit();
+                    else if (stopping) return;
+                    else std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+            catch (const std::exception& e)
+            {
+                error_ = e.what();
+                failed_.store(true, std::memory_order_release);
+            }
+            // Keep draining so producers never block on a dead writer.
+            while (running_.load(std::memory_order_acquire))
+            {
+                rings_.Drain(batch.data(), batch.size(), [](const EngineCommand&) {});
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+
+        void Append(const EngineCommand& command)
+        {
+            if (written_ == capacity_) Grow();
+            JournalRecord& record = reinterpret_cast<JournalRecord*>(memory_ + sizeof(JournalHeader))[written_];
+            record.command_ = command;
+            record.sequence_ = ++written_;
+            record.checksum_ = JournalChecksum(record);
+            appended_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Commit()
+        {
+            Sync(Offset(written_));
+            committed_ = written_;
+            commits_.fetch_add(1, std::memory_order_relaxed);
+            durable_.store(committed_, std::memory_order_release);
+        }
+
+        // msync works on whole pages, so start at the page holding the first unsynced byte.
+        void Sync(std::size_t end)
+        {
+            const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            const std::size_t start = synced_ / page * page;
+            if (end > start && msync(memory_ + start, end - start, MS_SYNC) != 0)
+                throw std::runtime_error(std::format("Cannot sync journal ({}): {}.", path_, std::strerror(errno)));
+            synced_ = end;
+        }
+
+        void Grow()
+        {
+            Commit();
+            munmap(memory_, Offset(capacity_));
+            memory_ = nullptr;
+            Map(capacity_ * 2);
+        }
+
+        // Allocates the file's blocks up front so appends never extend it, and makes the new size durable.
+        // Not pre-faulted: that would dirty every page and msync would write the zeros out too.
+        void Map(std::uint64_t records)
+        {
+            if (int error = posix_fallocate(fd_, 0, static_cast<off_t>(Offset(records))); error != 0)
+                throw std::runtime_error(std::format("Cannot pre-allocate journal ({}): {}.", path_, std::strerror(error)));
+            if (fdatasync(fd_) != 0)
+                throw std::runtime_error(std::format("Cannot sync journal ({}): {}.", path_, std::strerror(errno)));
+            void* memory = mmap(nullptr, Offset(records), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (memory == MAP_FAILED)
+                throw std::runtime_error(std::format("Cannot map journal ({}): {}.", path_, std::strerror(errno)));
+            memory_ = static_cast<char*>(memory);
+            capacity_ = records;
+        }
+};
+
+// One engine thread's handle on the journal: a ring of its own and a staging
+// batch, so commands reach the writer in bulk pushes. Blocks only if the
+// writer has fallen a whole ring behind.
+class JournalProducer
+{
+    public:
+        explicit JournalProducer(JournalWriter& writer): writer_ { writer }, ring_ { writer.Inbound().Acquire() } {}
+        JournalProducer(const JournalProducer&) = delete;
+        JournalProducer& operator=(const JournalProducer&) = delete;
+
+        ~JournalProducer()
+        {
+            Flush();
+            writer_.Inbound().Release(ring_);
+        }
+
+        void Post(const EngineCommand& command)
+        {
+            staged_[count_++] = command;
+            if (count_ == staged_.size()) Flush();
+        }
+
+        void Flush()
+        {
+            if (count_ == 0) return;
+            writer_.posted_.fetch_add(count_, std::memory_order_release);
+            const EngineCommand* commands = staged_.data();
+            while (count_ > 0)
+            {
+                const std::size_t pushed = ring_->try_push_n(commands, count_);
+                commands += pushed;
+                count_ -= pushed;
+                if (count_ > 0) std::this_thread::yield();
+            }
+        }
+
+    private:
+        JournalWriter& writer_;
+        JournalWriter::Rings::Ring* ring_;
+        std::array<EngineCommand, 256> staged_;
+        std::size_t count_ = 0;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear (HDR-style) histogram over a fixed array, so recording never
+// allocates. Values below 128 get a bucket each; above that, every power-of-two
+// range is split into 64 equal buckets, which keeps any reported value within
+// 1/64 of the true one. Units are whatever the caller records (clock ticks here).
+class LatencyHistogram
+{
+    public:
+        void Record(std::uint64_t value)
+        {
+            ++counts_[BucketOf(value)];
+            ++count_;
+            max_ = std::max(max_, value);
+        }
+
+        void Merge(const LatencyHistogram& other)
+        {
+            for (std::size_t i = 0; i < Buckets; ++i) counts_[i] += other.counts_[i];
+            count_ += other.count_;
+            max_ = std::max(max_, other.max_);
+        }
+
+        std::uint64_t Count() const { return count_; }
+        std::uint64_t Max() const { return max_; }
+
+        // Upper bound of the bucket holding the value at `percentile` (0-100).
+        std::uint64_t Percentile(double percentile) const
+        {
+            if (count_ == 0) return 0;
+            // Rounded rather than ceil'd, so 99.9 of 10000 is rank 9990 despite 99.9 not being exact in binary.
+            const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(percentile / 100.0 * count_ + 0.5));
+
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < Buckets; ++i)
+            {
+                seen += counts_[i];
+                if (seen >= rank) return std::min(UpperBound(i), max_);
+            }
+            return max_;
+        }
+
+    private:
+        static constexpr unsigned SubBits = 7;
+        static constexpr std::size_t Linear = std::size_t{1} << SubBits;
+        static constexpr std::size_t Half = Linear / 2;
+        static constexpr std::size_t Buckets = Linear + (64 - SubBits) * Half;
+
+        std::array<std::uint64_t, Buckets> counts_ {};
+        std::uint64_t count_ {};
+        std::uint64_t max_ {};
+
+        static std::size_t BucketOf(std::uint64_t value)
+        {
+            if (value < Linear) return static_cast<std::size_t>(value);
+            const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - SubBits;
+            return Linear + (shift - 1) * Half + static_cast<std::size_t>((value >> shift) - Half);
+        }
+
+        static std::uint64_t UpperBound(std::size_t bucket)
+        {
+            if (bucket < Linear) return bucket;
+            const std::size_t shift = (bucket - Linear) / Half + 1;
+            const std::uint64_t top = (bucket - Linear) % Half + Half;
+            return ((top + 1) << shift) - 1;
+        }
+};
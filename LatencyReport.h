@@ -0,0 +1,24 @@
+#pragma once
+#include <iomanip>
+#include <ostream>
+#include "CycleClock.h"
+#include "LatencyHistogram.h"
+
+// Fixed-width percentile table, in nanoseconds, for histograms recorded in CycleClock ticks.
+inline void PrintLatencyHeader(std::ostream& out)
+{
+    out << std::left << std::setw(15) << "  op" << std::right << std::setw(10) << "count"
+        << std::setw(9) << "p50" << std::setw(9) << "p90" << std::setw(9) << "p99"
+        << std::setw(9) << "p99.9" << std::setw(9) << "p99.99" << std::setw(11) << "max" << "\n";
+}
+
+inline void PrintLatencyRow(std::ostream& out, const char* name, const LatencyHistogram& histogram)
+{
+    if (histogram.Count() == 0) return;
+    auto ns = [&](double percentile) { return CycleClock::ToNanos(histogram.Percentile(percentile)); };
+    out << std::left << std::setw(15) << name << std::right
+        << std::setw(10) << histogram.Count()
+        << std::setw(9) << ns(50) << std::setw(9) << ns(90) << std::setw(9) << ns(99)
+        << std::setw(9) << ns(99.9) << std::setw(9) << ns(99.99)
+        << std::setw(11) << CycleClock::ToNanos(histogram.Max()) << "\n";
+}
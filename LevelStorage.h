@@ -0,0 +1,7 @@
+#pragma once
+
+enum class LevelStorage
+{
+    Map,
+    Ladder
+};
@@ -0,0 +1,188 @@
+#pragma once
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <format>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "BookView.h"
+#include "Seqlock.h"
+
+// Market data the engine shares with out-of-process readers (dashboard.py via
+// feed_reader.py, the feed_reader tool) through a POSIX shared-memory object,
+// /dev/shm/<name> on Linux. Every section is a Seqlock: the engine publishes
+// with plain stores and never waits, and readers copy a section out and retry
+// if it changed underneath them.
+//
+// The layout is part of the contract with the Python reader. A Seqlock puts
+// its sequence at offset 0 and its value at offset 64; the header records where
+// each section starts. Bump Version whenever any of these structs change.
+struct FeedSymbol
+{
+    char symbol_[8] {};
+    std::uint64_t engineOps_ {};      // per second
+    std::uint64_t totalEngine_ {};
+    std::uint64_t poolLive_ {};
+    std::uint64_t poolHighWater_ {};
+    std::uint64_t poolChunks_ {};
+    std::uint64_t poolExhausted_ {};
+};
+
+struct FeedShard
+{
+    std::uint64_t core_ {};
+    std::uint64_t engineOps_ {};      // per second
+    std::uint64_t totalEngine_ {};
+};
+
+struct FeedCounters
+{
+    static constexpr std::size_t MaxSymbols = 32;
+    static constexpr std::size_t MaxShards = 64;
+
+    std::uint64_t updates_ {};        // bumped on every publish, so readers can tell a stale feed
+    std::uint64_t networkOps_ {};     // per second
+    std::uint64_t engineOps_ {};      // per second
+    std::uint64_t totalNetwork_ {};
+    std::uint64_t totalEngine_ {};
+    std::uint64_t unknownSymbol_ {};
+    std::uint32_t symbolCount_ {};
+    std::uint32_t shardCount_ {};
+    FeedSymbol symbols_[MaxSymbols] {};
+    FeedShard shards_[MaxShards] {};
+};
+
+struct FeedHeader
+{
+    static constexpr char Magic[8] = { 'O', 'B', 'F', 'E', 'E', 'D', 0, 0 };
+    static constexpr std::uint32_t Version = 1;
+
+    char magic_[8] {};
+    std::uint32_t version_ {};
+    std::uint32_t depth_ {};          // BookView::Depth
+    std::uint64_t bookOffset_ {};
+    std::uint64_t countersOffset_ {};
+    std::uint64_t size_ {};
+    char bookSymbol_[8] {};           // the symbol the depth section follows
+};
+
+struct FeedLayout
+{
+    FeedHeader header_;
+    Seqlock<BookView> book_;
+    Seqlock<FeedCounters> counters_;
+};
+
+// Owns the shared-memory object: creates (or replaces) it on construction and
+// unlinks it on destruction, so a reader that outlives the engine keeps its
+// mapping but a new reader does not attach to a dead feed.
+class MarketDataFeed
+{
+    public:
+        static constexpr const char* DefaultName = "/orderbook_feed";
+
+        explicit MarketDataFeed(const char (&bookSymbol)[8], std::string name = DefaultName): name_ { std::move(name) }
+        {
+            const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+            if (fd < 0) throw std::runtime_error(std::format("Cannot create market data feed ({}): {}.", name_, std::strerror(errno)));
+            if (ftruncate(fd, sizeof(FeedLayout)) != 0)
+            {
+                const int error = errno;
+                close(fd);
+                shm_unlink(name_.c_str());
+                throw std::runtime_error(std::format("Cannot size market data feed ({}): {}.", name_, std::strerror(error)));
+            }
+            void* memory = mmap(nullptr, sizeof(FeedLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (memory == MAP_FAILED)
+            {
+                shm_unlink(name_.c_str());
+                throw std::runtime_error(std::format("Cannot map market data feed ({}): {}.", name_, std::strerror(errno)));
+            }
+
+            layout_ = new(memory) FeedLayout {};
+            FeedHeader& header = layout_->header_;
+            header.version_ = FeedHeader::Version;
+            header.depth_ = BookView::Depth;
+            header.bookOffset_ = offsetof(FeedLayout, book_);
+            header.countersOffset_ = offsetof(FeedLayout, counters_);
+            header.size_ = sizeof(FeedLayout);
+            std::memcpy(header.bookSymbol_, bookSymbol, sizeof(header.bookSymbol_));
+            // The magic goes in last: a reader that sees it sees a complete header.
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(header.magic_, FeedHeader::Magic, sizeof(header.magic_));
+        }
+        MarketDataFeed(const MarketDataFeed&) = delete;
+        MarketDataFeed& operator=(const MarketDataFeed&) = delete;
+
+        ~MarketDataFeed()
+        {
+            munmap(layout_, sizeof(FeedLayout));
+            shm_unlink(name_.c_str());
+        }
+
+        // The depth section. Hand it to OrderBook::MirrorViewTo so every view the
+        // book publishes lands here too; the book's writer is then its only writer.
+        Seqlock<BookView>& Book() { return layout_->book_; }
+
+        // Called from one thread only (the engine's metrics thread).
+        void PublishCounters(FeedCounters counters)
+        {
+            counters.updates_ = ++updates_;
+            layout_->counters_.Store(counters);
+        }
+
+        const std::string& Name() const { return name_; }
+
+    private:
+        std::string name_;
+        FeedLayout* layout_ { nullptr };
+        std::uint64_t updates_ { 0 };
+};
+
+// Read-only attachment to a feed some engine process has created.
+class MarketDataFeedReader
+{
+    public:
+        explicit MarketDataFeedReader(const std::string& name = MarketDataFeed::DefaultName)
+        {
+            const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd < 0) throw std::runtime_error(std::format("Cannot open market data feed ({}): {}.", name, std::strerror(errno)));
+            struct stat info {};
+            if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(FeedLayout))
+            {
+                close(fd);
+                throw std::runtime_error(std::format("Market data feed ({}) is too small to be a version {} feed.", name, FeedHeader::Version));
+            }
+            void* memory = mmap(nullptr, sizeof(FeedLayout), PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (memory == MAP_FAILED) throw std::runtime_error(std::format("Cannot map market data feed ({}): {}.", name, std::strerror(errno)));
+            layout_ = static_cast<const FeedLayout*>(memory);
+
+            const FeedHeader& header = layout_->header_;
+            if (std::memcmp(header.magic_, FeedHeader::Magic, sizeof(header.magic_)) != 0 || header.version_ != FeedHeader::Version)
+            {
+                munmap(memory, sizeof(FeedLayout));
+                throw std::runtime_error(std::format("Market data feed ({}) is not a version {} feed.", name, FeedHeader::Version));
+            }
+        }
+        MarketDataFeedReader(const MarketDataFeedReader&) = delete;
+        MarketDataFeedReader& operator=(const MarketDataFeedReader&) = delete;
+
+        ~MarketDataFeedReader() { munmap(const_cast<FeedLayout*>(layout_), sizeof(FeedLayout)); }
+
+        const FeedHeader& Header() const { return layout_->header_; }
+        BookView ReadBook() const { return layout_->book_.Load(); }
+        FeedCounters ReadCounters() const { return layout_->counters_.Load(); }
+
+    private:
+        const FeedLayout* layout_ { nullptr };
+};
@@ -0,0 +1,559 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <format>
+#include <boost/asio.hpp>
+#include "Protocol.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// The live server's network ingest back ends. Each runs a fixed set of I/O
+// threads, and each thread decodes every connection it owns into its own
+// Router: any type with an operator() for each message struct and a Flush()
+// the thread calls once per batch of reads.
+//
+// Both count the receive syscalls they make so the two can be compared without
+// strace: the Asio path counts one per completed read, which is a floor since
+// a read that would block also costs an epoll_wait; the io_uring path counts
+// its io_uring_enter calls, which is every syscall it makes once running.
+
+// One Asio I/O thread: an io_context that only this thread runs, serving the
+// sockets the accepting thread hands it.
+template <typename Router>
+class AsioIngestThread
+{
+    public:
+        explicit AsioIngestThread(Router router): work_ { boost::asio::make_work_guard(context_) }, router_ { std::move(router) } {}
+
+        // Accept sockets onto this context; Serve then starts reading them here.
+        boost::asio::io_context& Context() { return context_; }
+
+        void Serve(boost::asio::ip::tcp::socket socket)
+        {
+            auto connection = std::make_shared<Connection>(std::move(socket), router_, syscalls_);
+            boost::asio::post(context_, [connection]() { connection->Start(); });
+        }
+
+        void Start() { thread_ = std::thread([this]() { context_.run(); }); }
+        void Stop()
+        {
+            work_.reset();
+            context_.stop();
+            if (thread_.joinable()) thread_.join();
+        }
+
+        uint64_t Syscalls() const { return syscalls_.load(std::memory_order_relaxed); }
+
+    private:
+        // A client socket driven by the thread's event loop. Every read lands behind
+        // the previous read's partial frame, whole frames are decoded in place, and
+        // the remainder is moved to the front; a frame is at most a few dozen bytes.
+        class Connection : public std::enable_shared_from_this<Connection>
+        {
+            public:
+                Connection(boost::asio::ip::tcp::socket socket, Router& router, std::atomic<uint64_t>& syscalls):
+                socket_ { std::move(socket) }, router_ { router }, syscalls_ { syscalls } {}
+
+                void Start() { Read(); }
+
+            private:
+                static constexpr size_t buffer_size = 65536;
+
+                boost::asio::ip::tcp::socket socket_;
+                Router& router_;
+                std::atomic<uint64_t>& syscalls_;
+                std::unique_ptr<char[]> buffer_ { new char[buffer_size] };
+                size_t leftover_ = 0;
+
+                void Read()
+                {
+                    socket_.async_read_some(boost::asio::buffer(buffer_.get() + leftover_, buffer_size - leftover_),
+                        [self = this->shared_from_this()](const boost::system::error_code& error, size_t length) { self->OnRead(error, length); });
+                }
+
+                // Returning without another Read drops the last reference, which closes the socket.
+                void OnRead(const boost::system::error_code& error, size_t length)
+                {
+                    syscalls_.fetch_add(1, std::memory_order_relaxed);
+                    if (error == boost::asio::error::eof || error == boost::asio::error::connection_reset)
+                    {
+                        std::cout << "[NETWORK] Client Disconnected.\n";
+                        return;
+                    }
+                    if (error)
+                    {
+                        std::cerr << "[NETWORK] Client read failed: " << error.message() << "\n";
+                        return;
+                    }
+                    try
+                    {
+                        size_t total_bytes = leftover_ + length;
+                        size_t consumed_bytes = DecodeFrames(buffer_.get(), total_bytes, router_);
+                        router_.Flush();
+                        leftover_ = total_bytes - consumed_bytes;
+                        if (leftover_ > 0) std::memmove(buffer_.get(), buffer_.get() + consumed_bytes, leftover_);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        router_.Flush();
+                        std::cerr << "[NETWORK] Client Exception: " << e.what() << "\n";
+                        return;
+                    }
+                    Read();
+                }
+        };
+
+        boost::asio::io_context context_ { 1 };
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+        Router router_;
+        std::atomic<uint64_t> syscalls_ { 0 };
+        std::thread thread_;
+};
+
+#ifdef __linux__
+
+// A bare io_uring instance (no liburing): the mapped submission and completion
+// rings of one thread, which is their only user.
+class IoUring
+{
+    public:
+        explicit IoUring(unsigned entries)
+        {
+            io_uring_params params {};
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = entries * 8; // multishot receives post many completions per submission
+            fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (fd_ < 0) throw std::runtime_error(std::format("io_uring_setup failed: {}.", std::strerror(errno)));
+            if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0 || (params.features & IORING_FEAT_NODROP) == 0)
+            {
+                Release();
+                throw std::runtime_error("io_uring lacks single-mmap rings or no-drop completions (needs Linux 5.5+).");
+            }
+
+            ringSize_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                 params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+            void* ring = mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+            if (ring == MAP_FAILED)
+            {
+                const int error = errno;
+                ringSize_ = 0;
+                Release();
+                throw std::runtime_error(std::format("Cannot map io_uring rings: {}.", std::strerror(error)));
+            }
+            ring_ = static_cast<char*>(ring);
+            sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+            void* sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+            if (sqes == MAP_FAILED)
+            {
+                const int error = errno;
+                sqesSize_ = 0;
+                Release();
+                throw std::runtime_error(std::format("Cannot map io_uring submission entries: {}.", std::strerror(error)));
+            }
+            sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+            sqHead_ = reinterpret_cast<unsigned*>(ring_ + params.sq_off.head);
+            sqTail_ = reinterpret_cast<unsigned*>(ring_ + params.sq_off.tail);
+            sqArray_ = reinterpret_cast<unsigned*>(ring_ + params.sq_off.array);
+            sqMask_ = *reinterpret_cast<unsigned*>(ring_ + params.sq_off.ring_mask);
+            sqEntries_ = params.sq_entries;
+            cqHead_ = reinterpret_cast<unsigned*>(ring_ + params.cq_off.head);
+            cqTail_ = reinterpret_cast<unsigned*>(ring_ + params.cq_off.tail);
+            cqMask_ = *reinterpret_cast<unsigned*>(ring_ + params.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<io_uring_cqe*>(ring_ + params.cq_off.cqes);
+            tail_ = *sqTail_;
+        }
+        IoUring(const IoUring&) = delete;
+        IoUring& operator=(const IoUring&) = delete;
+
+        ~IoUring() { Release(); }
+
+        int Fd() const { return fd_; }
+
+        // A cleared entry queued for the next Submit; submits first if the queue is full.
+        io_uring_sqe& NextEntry()
+        {
+            if (tail_ - std::atomic_ref<unsigned>(*sqHead_).load(std::memory_order_acquire) == sqEntries_) Submit(0);
+            const unsigned index = tail_ & sqMask_;
+            sqArray_[index] = index;
+            ++tail_;
+            sqes_[index] = io_uring_sqe {};
+            return sqes_[index];
+        }
+
+        // Hands every queued entry to the kernel and waits for at least `waitFor` completions.
+        void Submit(unsigned waitFor)
+        {
+            std::atomic_ref<unsigned>(*sqTail_).store(tail_, std::memory_order_release);
+            const unsigned pending = tail_ - std::atomic_ref<unsigned>(*sqHead_).load(std::memory_order_acquire);
+            const long result = syscall(__NR_io_uring_enter, fd_, pending, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            enters_.fetch_add(1, std::memory_order_relaxed);
+            if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                throw std::runtime_error(std::format("io_uring_enter failed: {}.", std::strerror(errno)));
+        }
+
+        // Hands each posted completion to `handler` by value, then frees their slots.
+        template <typename Handler>
+        void DrainCompletions(Handler&& handler)
+        {
+            unsigned head = *cqHead_;
+            const unsigned tail = std::atomic_ref<unsigned>(*cqTail_).load(std::memory_order_acquire);
+            for (; head != tail; ++head) handler(io_uring_cqe { cqes_[head & cqMask_] });
+            std::atomic_ref<unsigned>(*cqHead_).store(head, std::memory_order_release);
+        }
+
+        uint64_t Enters() const { return enters_.load(std::memory_order_relaxed); }
+
+    private:
+        int fd_ { -1 };
+        char* ring_ { nullptr };
+        size_t ringSize_ { 0 };
+        io_uring_sqe* sqes_ { nullptr };
+        size_t sqesSize_ { 0 };
+        unsigned* sqHead_ { nullptr };
+        unsigned* sqTail_ { nullptr };
+        unsigned* sqArray_ { nullptr };
+        unsigned sqMask_ { 0 };
+        unsigned sqEntries_ { 0 };
+        unsigned* cqHead_ { nullptr };
+        unsigned* cqTail_ { nullptr };
+        unsigned cqMask_ { 0 };
+        io_uring_cqe* cqes_ { nullptr };
+        unsigned tail_ { 0 };
+        std::atomic<uint64_t> enters_ { 0 };
+
+        void Release()
+        {
+            if (sqes_ != nullptr) munmap(sqes_, sqesSize_);
+            if (ring_ != nullptr) munmap(ring_, ringSize_);
+            if (fd_ >= 0) close(fd_);
+        }
+};
+
+// A provided-buffer ring registered with an IoUring (Linux 5.19+): receives
+// that select from its group take a buffer, the completion says which, and
+// Recycle gives it back once the frames in it are decoded.
+class BufferRing
+{
+    public:
+        BufferRing(int ringFd, uint16_t group, unsigned count, unsigned size):
+        ringFd_ { ringFd }, group_ { group }, count_ { count }, size_ { size }, data_ { new char[size_t { count } * size] }
+        {
+            if (count == 0 || count > 32768 || (count & (count - 1)) != 0)
+                throw std::invalid_argument(std::format("Buffer ring size ({}) must be a power of two up to 32768.", count));
+            void* ring = mmap(nullptr, count * sizeof(io_uring_buf), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+            if (ring == MAP_FAILED) throw std::runtime_error(std::format("Cannot map buffer ring: {}.", std::strerror(errno)));
+            bufs_ = static_cast<io_uring_buf*>(ring);
+
+            io_uring_buf_reg registration {};
+            registration.ring_addr = reinterpret_cast<uint64_t>(bufs_);
+            registration.ring_entries = count;
+            registration.bgid = group;
+            if (syscall(__NR_io_uring_register, ringFd_, IORING_REGISTER_PBUF_RING, &registration, 1) != 0)
+            {
+                const int error = errno;
+                munmap(bufs_, count_ * sizeof(io_uring_buf));
+                throw std::runtime_error(std::format("Cannot register buffer ring (needs Linux 5.19+): {}.", std::strerror(error)));
+            }
+            for (unsigned id = 0; id < count; ++id) Stage(static_cast<uint16_t>(id));
+            Publish();
+        }
+        BufferRing(const BufferRing&) = delete;
+        BufferRing& operator=(const BufferRing&) = delete;
+
+        ~BufferRing()
+        {
+            io_uring_buf_reg registration {};
+            registration.bgid = group_;
+            syscall(__NR_io_uring_register, ringFd_, IORING_UNREGISTER_PBUF_RING, &registration, 1);
+            munmap(bufs_, count_ * sizeof(io_uring_buf));
+        }
+
+        uint16_t Group() const { return group_; }
+        const char* Data(uint16_t id) const { return data_.get() + size_t { id } * size_; }
+
+        void Recycle(uint16_t id)
+        {
+            Stage(id);
+            Publish();
+        }
+
+    private:
+        int ringFd_;
+        uint16_t group_;
+        unsigned count_;
+        unsigned size_;
+        std::unique_ptr<char[]> data_;
+        io_uring_buf* bufs_ { nullptr };
+        uint16_t tail_ { 0 };
+
+        // Field by field: the ring's tail overlays the first entry's reserved field.
+        void Stage(uint16_t id)
+        {
+            io_uring_buf& buf = bufs_[tail_ & (count_ - 1)];
+            buf.addr = reinterpret_cast<uint64_t>(data_.get() + size_t { id } * size_);
+            buf.len = size_;
+            buf.bid = id;
+            ++tail_;
+        }
+
+        void Publish() { std::atomic_ref<uint16_t>(reinterpret_cast<io_uring_buf_ring*>(bufs_)->tail).store(tail_, std::memory_order_release); }
+};
+
+// One io_uring I/O thread. A multishot accept on the shared listening socket
+// brings in connections, and one multishot receive per connection has the
+// kernel fill buffers from the thread's BufferRing and post a completion per
+// fill, so a steady stream needs no resubmission; a single io_uring_enter both
+// submits and collects a whole batch of them. Frames are decoded straight out
+// of the kernel-filled buffers.
+//
+// The constructor throws when the kernel cannot do any of this, so callers
+// can fall back to AsioIngestThread.
+template <typename Router>
+class UringIngestThread
+{
+    public:
+        UringIngestThread(Router router, int listenFd): router_ { std::move(router) }, listenFd_ { listenFd }
+        {
+            if (wake_ < 0) throw std::runtime_error(std::format("Cannot create io_uring wake-up eventfd: {}.", std::strerror(errno)));
+            try
+            {
+                ProbeMultishotReceive();
+            }
+            catch (...)
+            {
+                close(wake_);
+                throw;
+            }
+        }
+        UringIngestThread(const UringIngestThread&) = delete;
+        UringIngestThread& operator=(const UringIngestThread&) = delete;
+
+        ~UringIngestThread()
+        {
+            Stop();
+            for (auto& connection : connections_)
+                if (connection) close(connection->fd_);
+            close(wake_);
+        }
+
+        void Start() { thread_ = std::thread([this]() { Run(); }); }
+        void Stop()
+        {
+            if (!thread_.joinable()) return;
+            running_.store(false, std::memory_order_relaxed);
+            const uint64_t one = 1;
+            if (write(wake_, &one, sizeof(one)) != sizeof(one)) std::cerr << "[NETWORK] Cannot wake io_uring thread: " << std::strerror(errno) << "\n";
+            thread_.join();
+        }
+
+        uint64_t Syscalls() const { return ring_.Enters(); }
+
+    private:
+        static constexpr unsigned ring_entries = 256;
+        static constexpr unsigned buffer_count = 128;
+        static constexpr unsigned buffer_size = 65536;
+        static constexpr uint64_t accept_tag = ~uint64_t { 0 };
+        static constexpr uint64_t wake_tag = accept_tag - 1;
+
+        struct Connection
+        {
+            int fd_;
+            FrameReassembler frames_;
+            bool closing_ = false;
+        };
+
+        Router router_;
+        int listenFd_;
+        IoUring ring_ { ring_entries };
+        BufferRing buffers_ { ring_.Fd(), 0, buffer_count, buffer_size };
+        int wake_ { eventfd(0, EFD_CLOEXEC) };
+        uint64_t wakeValue_ = 0;
+        std::vector<std::unique_ptr<Connection>> connections_; // indexed by the receive's user_data
+        std::vector<uint64_t> freeSlots_;
+        std::atomic<bool> running_ { true };
+        std::thread thread_;
+
+        void Run()
+        {
+            ArmAccept();
+            ArmWake();
+            try
+            {
+                while (running_.load(std::memory_order_relaxed))
+                {
+                    ring_.Submit(1);
+                    ring_.DrainCompletions([this](const io_uring_cqe& cqe) { Complete(cqe); });
+                    router_.Flush();
+                }
+            }
+            catch (const std::exception& e)
+            {
+                router_.Flush();
+                std::cerr << "[NETWORK] io_uring thread failed: " << e.what() << "\n";
+            }
+        }
+
+        void Complete(const io_uring_cqe& cqe)
+        {
+            if (cqe.user_data == wake_tag) return;
+            if (cqe.user_data == accept_tag)
+            {
+                if (cqe.res >= 0) Open(cqe.res);
+                else std::cerr << "Accept error: " << std::strerror(-cqe.res) << "\n";
+                if ((cqe.flags & IORING_CQE_F_MORE) == 0 && cqe.res != -EBADF && cqe.res != -EINVAL) ArmAccept();
+                return;
+            }
+
+            const uint64_t slot = cqe.user_data;
+            Connection& connection = *connections_[slot];
+            if ((cqe.flags & IORING_CQE_F_BUFFER) != 0)
+            {
+                const auto id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                if (cqe.res > 0 && !connection.closing_) Receive(connection, buffers_.Data(id), static_cast<size_t>(cqe.res));
+                buffers_.Recycle(id);
+            }
+            if ((cqe.flags & IORING_CQE_F_MORE) != 0) return;
+
+            // The multishot receive has ended. Running out of buffers or CQ space ends it too; start another.
+            if (!connection.closing_ && (cqe.res > 0 || cqe.res == -ENOBUFS))
+            {
+                ArmReceive(slot);
+                return;
+            }
+            if (!connection.closing_)
+            {
+                if (cqe.res == 0 || cqe.res == -ECONNRESET) std::cout << "[NETWORK] Client Disconnected.\n";
+                else std::cerr << "[NETWORK] Client read failed: " << std::strerror(-cqe.res) << "\n";
+            }
+            close(connection.fd_);
+            connections_[slot].reset();
+            freeSlots_.push_back(slot);
+        }
+
+        void Receive(Connection& connection, const char* data, size_t size)
+        {
+            try
+            {
+                connection.frames_.Consume(data, size, router_);
+            }
+            catch (const std::exception& e)
+            {
+                // Shutting the socket down ends its receive; the slot is freed on that final completion.
+                std::cerr << "[NETWORK] Client Exception: " << e.what() << "\n";
+                connection.closing_ = true;
+                shutdown(connection.fd_, SHUT_RDWR);
+            }
+        }
+
+        void Open(int fd)
+        {
+            uint64_t slot = connections_.size();
+            if (!freeSlots_.empty())
+            {
+                slot = freeSlots_.back();
+                freeSlots_.pop_back();
+            }
+            else connections_.emplace_back();
+            connections_[slot] = std::make_unique<Connection>(Connection { fd, {} });
+            ArmReceive(slot);
+        }
+
+        void ArmAccept()
+        {
+            io_uring_sqe& sqe = ring_.NextEntry();
+            sqe.opcode = IORING_OP_ACCEPT;
+            sqe.fd = listenFd_;
+            sqe.ioprio = IORING_ACCEPT_MULTISHOT;
+            sqe.accept_flags = SOCK_CLOEXEC;
+            sqe.user_data = accept_tag;
+        }
+
+        void ArmReceive(uint64_t slot)
+        {
+            PrepareReceive(connections_[slot]->fd_, slot);
+        }
+
+        void PrepareReceive(int fd, uint64_t tag)
+        {
+            io_uring_sqe& sqe = ring_.NextEntry();
+            sqe.opcode = IORING_OP_RECV;
+            sqe.fd = fd;
+            sqe.ioprio = IORING_RECV_MULTISHOT;
+            sqe.flags = IOSQE_BUFFER_SELECT;
+            sqe.buf_group = buffers_.Group();
+            sqe.user_data = tag;
+        }
+
+        void ArmWake()
+        {
+            io_uring_sqe& sqe = ring_.NextEntry();
+            sqe.opcode = IORING_OP_READ;
+            sqe.fd = wake_;
+            sqe.addr = reinterpret_cast<uint64_t>(&wakeValue_);
+            sqe.len = sizeof(wakeValue_);
+            sqe.user_data = wake_tag;
+        }
+
+        // Buffer rings and multishot accept arrived in 5.19 but multishot receive
+        // only in 6.0, so try one on a socket pair rather than trust the version.
+        void ProbeMultishotReceive()
+        {
+            int pair[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0)
+                throw std::runtime_error(std::format("Cannot create io_uring probe sockets: {}.", std::strerror(errno)));
+            const char byte = 0;
+            const bool sent = send(pair[1], &byte, 1, 0) == 1;
+            shutdown(pair[1], SHUT_WR);
+            PrepareReceive(pair[0], 0);
+
+            // Expect the byte with more to come, then the end of the stream.
+            bool supported = sent;
+            int seen = 0;
+            while (supported && seen < 2)
+            {
+                ring_.Submit(1);
+                ring_.DrainCompletions([&](const io_uring_cqe& cqe)
+                {
+                    if ((cqe.flags & IORING_CQE_F_BUFFER) != 0) buffers_.Recycle(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+                    if (seen++ == 0) supported = supported && cqe.res == 1 && (cqe.flags & IORING_CQE_F_MORE) != 0;
+                    else supported = supported && cqe.res == 0;
+                });
+            }
+            close(pair[0]);
+            close(pair[1]);
+            if (!supported) throw std::runtime_error("io_uring has no multishot receive (needs Linux 6.0+).");
+        }
+};
+
+#else
+
+// io_uring is Linux-only; constructing this always fails so callers fall back to Asio.
+template <typename Router>
+class UringIngestThread
+{
+    public:
+        UringIngestThread(Router, int) { throw std::runtime_error("io_uring ingest needs Linux."); }
+        void Start() {}
+        void Stop() {}
+        uint64_t Syscalls() const { return 0; }
+};
+
+#endif
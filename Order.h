@@ -1,22 +1,31 @@
 #pragma once
-#include <list>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <exception>
 #include <format>
+#include <utility>
 #include "OrderType.h"
 #include "Side.h"
 #include "Usings.h"
 #include "Constants.h"
 
-class Order
+class OrderList;
+
+// 32 bytes, aligned so two orders share a cache line and none straddles one.
+// The fields a level walk in Sweep reads (next link, id, price,
+// remaining quantity) come first. Side and type are read off the matching
+// path, so they ride in the low bits of the back link, which alignment leaves
+// free. The initial quantity is not kept: an order is only inspected at its
+// full size when it arrives, where it equals the remaining quantity.
+class alignas(32) Order
 {
     public:
         Order (OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity): 
-        orderType_{ orderType }, 
         orderId_{ orderId },
-        side_{ side },
         price_ { price },
-        initialQuantity_ { quantity },
-        remainingQuantity_ {quantity}
+        remainingQuantity_ {quantity},
+        prevAndFlags_ { Flags(orderType, side) }
         {}
         Order() = default;
         Order (OrderId orderId, Side side, Quantity quantity):
@@ -24,12 +33,10 @@ class Order
         {}
 
         OrderId GetOrderId() const { return orderId_; }
-        Side GetOrderSide() const { return side_; }
+        Side GetOrderSide() const { return static_cast<Side>((prevAndFlags_ & SideMask) >> TypeBits); }
         Price GetPrice() const { return price_; }
-        OrderType GetOrderType() const { return orderType_; }
-        Quantity GetInitialQuantity() const { return initialQuantity_; }
+        OrderType GetOrderType() const { return static_cast<OrderType>(prevAndFlags_ & TypeMask); }
         Quantity GetRemainingQuantity() const { return remainingQuantity_; }
-        Quantity GetFilledQuantity() const { return GetInitialQuantity() - GetRemainingQuantity(); }
         bool isFilled() const {return GetRemainingQuantity() == 0; }
         void Fill(Quantity quantity)
         {
@@ -45,17 +52,137 @@ class Order
                 throw std::logic_error(std::format("Order ({}) cannot have its price adjusted, only market orders can.", GetOrderId()));
 
             price_ = price;
-            orderType_ = OrderType::GoodTillCancel;
+            prevAndFlags_ = (prevAndFlags_ & ~TypeMask) | static_cast<std::uintptr_t>(OrderType::GoodTillCancel);
         }
 
         private:
-            OrderType orderType_;
+            friend class OrderList;
+
+            static constexpr std::uintptr_t TypeBits = 3;
+            static constexpr std::uintptr_t TypeMask = (std::uintptr_t { 1 } << TypeBits) - 1;
+            static constexpr std::uintptr_t SideMask = std::uintptr_t { 1 } << TypeBits;
+            static constexpr std::uintptr_t FlagMask = TypeMask | SideMask;
+            static_assert(FlagMask < 32, "flags must fit in the link bits the alignment leaves free");
+
+            static std::uintptr_t Flags(OrderType orderType, Side side)
+            {
+                return static_cast<std::uintptr_t>(orderType) | static_cast<std::uintptr_t>(side) << TypeBits;
+            }
+            Order* prev() const { return reinterpret_cast<Order*>(prevAndFlags_ & ~FlagMask); }
+            void setPrev(Order* order) { prevAndFlags_ = reinterpret_cast<std::uintptr_t>(order) | (prevAndFlags_ & FlagMask); }
+
+            Order* next_ { nullptr };
             OrderId orderId_;
-            Side side_;
             Price price_;
-            Quantity initialQuantity_;
             Quantity remainingQuantity_;
+            std::uintptr_t prevAndFlags_ { 0 }; // previous order in the level | side << 3 | type
 };
 
+static_assert(sizeof(Order) == 32);
+
 using OrderPointer = Order*;
-using OrderPointers = std::list<OrderPointer>;
\ No newline at end of file
+
+// Intrusive FIFO of the orders resting at one price level. The links live in
+// the Order itself, so queueing an order never allocates and the Order pointer
+// is its own handle for O(1) removal from the middle of the queue. The level's
+// total remaining quantity is kept up to date as orders join, leave and fill,
+// so depth queries never walk the queue. Fills must go through fill() for it
+// to stay exact.
+class OrderList
+{
+    public:
+        class iterator
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = OrderPointer;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const OrderPointer*;
+                using reference = OrderPointer;
+
+                iterator() = default;
+                explicit iterator(OrderPointer order): order_ { order } {}
+
+                OrderPointer operator*() const { return order_; }
+                iterator& operator++() { order_ = order_->next_; return *this; }
+                iterator operator++(int) { iterator previous = *this; ++*this; return previous; }
+                bool operator==(const iterator&) const = default;
+
+            private:
+                OrderPointer order_ { nullptr };
+        };
+
+        OrderList() = default;
+        OrderList(const OrderList&) = delete;
+        OrderList& operator=(const OrderList&) = delete;
+        OrderList(OrderList&& other) noexcept { swap(other); }
+        OrderList& operator=(OrderList&& other) noexcept { swap(other); return *this; }
+
+        bool empty() const { return head_ == nullptr; }
+        std::size_t size() const { return size_; }
+        Quantity quantity() const { return quantity_; }
+        OrderPointer front() const { return head_; }
+        OrderPointer back() const { return tail_; }
+        iterator begin() const { return iterator { head_ }; }
+        iterator end() const { return iterator {}; }
+
+        void push_back(OrderPointer order)
+        {
+            order->setPrev(tail_);
+            order->next_ = nullptr;
+            if (tail_ != nullptr) tail_->next_ = order;
+            else head_ = order;
+            tail_ = order;
+            ++size_;
+            quantity_ += order->GetRemainingQuantity();
+        }
+
+        void pop_front() { erase(head_); }
+
+        void erase(OrderPointer order)
+        {
+            OrderPointer prev = order->prev();
+            if (prev != nullptr) prev->next_ = order->next_;
+            else head_ = order->next_;
+            if (order->next_ != nullptr) order->next_->setPrev(prev);
+            else tail_ = prev;
+            order->setPrev(nullptr);
+            order->next_ = nullptr;
+            --size_;
+            quantity_ -= order->GetRemainingQuantity();
+        }
+
+        void fill(OrderPointer order, Quantity quantity)
+        {
+            order->Fill(quantity);
+            quantity_ -= quantity;
+        }
+
+        void clear() { while (!empty()) pop_front(); }
+
+        // Empties the list without unlinking its orders one by one, for a caller
+        // that has already disposed of every one of them.
+        void reset()
+        {
+            head_ = nullptr;
+            tail_ = nullptr;
+            size_ = 0;
+            quantity_ = 0;
+        }
+
+        void swap(OrderList& other) noexcept
+        {
+            std::swap(head_, other.head_);
+            std::swap(tail_, other.tail_);
+            std::swap(size_, other.size_);
+            std::swap(quantity_, other.quantity_);
+        }
+
+    private:
+        OrderPointer head_ { nullptr };
+        OrderPointer tail_ { nullptr };
+        std::size_t size_ { 0 };
+        Quantity quantity_ { 0 };
+};
+
+using OrderPointers = OrderList;
\ No newline at end of file
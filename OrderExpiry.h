@@ -0,0 +1,245 @@
+#pragma once
+#include <bit>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Usings.h"
+#include "Order.h"
+
+// The resting orders that leave the book by the clock rather than by trading
+// or a cancel, so expiring them never means scanning the book.
+//
+// GoodForDay orders share one deadline, the session close, so they sit on one
+// list that CloseSession empties. Good-till-time orders carry their own deadline
+// and sit on a hierarchical timer wheel of Levels levels of 64 slots, where a
+// level-L slot spans 64^L ticks of TickNanos. An order goes on the level of the
+// highest 6-bit group in which its deadline tick differs from the wheel's clock,
+// so the orders on level 0 are due at their slot's tick, and an order higher up
+// only comes due once the clock enters its slot; the orders there are then
+// moved down a level or more. Advance jumps from one occupied slot to the next
+// through a per-level occupancy word, so it costs O(expired + moved down) however
+// long the clock has been idle, and scheduling or removing an order is O(1).
+//
+// Each timed order gets a node in one slab, named by a Handle that the book
+// keeps in place of the order's pointer and that leads back to the order, so
+// untimed orders pay nothing for any of this.
+class OrderExpiry
+{
+    public:
+        using Handle = std::uint32_t;
+        static constexpr std::int64_t TickNanos = 1'000'000;
+
+        // Reserving address space for `expected` nodes costs no memory until they are used.
+        explicit OrderExpiry(std::size_t expected = 1024) { nodes_.reserve(expected); }
+
+        std::size_t Size() const { return size_; }
+        // The clock's last tick: good-till-time orders due by then are gone.
+        Timestamp Now() const { return Timestamp { std::chrono::nanoseconds { static_cast<std::int64_t>(nowTick_) * TickNanos } }; }
+        // No good-till-time order comes due before this; Timestamp::max() if none is waiting.
+        Timestamp NextDue() const
+        {
+            if (occupiedLevels_ == 0) return Timestamp::max();
+            const unsigned level = std::countr_zero(occupiedLevels_);
+            const std::uint64_t start = SlotStart(level, std::countr_zero(occupied_[level]));
+            return Timestamp { std::chrono::nanoseconds { static_cast<std::int64_t>(start) * TickNanos } };
+        }
+
+        Handle AddToSession(OrderPointer order)
+        {
+            const Handle node = Allocate(order, SessionTick);
+            Link(sessionHead_, node);
+            return node;
+        }
+
+        // The deadline must fall after Now(); it is kept to the tick, rounded up.
+        Handle Schedule(OrderPointer order, Timestamp deadline)
+        {
+            const Handle node = Allocate(order, DeadlineTick(deadline));
+            Place(node);
+            return node;
+        }
+
+        OrderPointer OrderOf(Handle node) const { return nodes_[node].order_; }
+        // A scheduled order's deadline, to the tick; Timestamp {} for a GoodForDay order.
+        Timestamp DeadlineOf(Handle node) const
+        {
+            if (nodes_[node].tick_ == SessionTick) return Timestamp {};
+            return Timestamp { std::chrono::nanoseconds { static_cast<std::int64_t>(nodes_[node].tick_) * TickNanos } };
+        }
+
+        // For an order leaving the book any other way.
+        void Remove(Handle node)
+        {
+            Unlink(node);
+            Free(node);
+        }
+
+        // Moves the clock to `now` and hands every good-till-time order due by then
+        // to `expire`, earliest tick first. Each order is forgotten before it is handed over.
+        template <typename Expire>
+        void Advance(Timestamp now, Expire&& expire)
+        {
+            const auto nanos = now.time_since_epoch().count();
+            const std::uint64_t target = nanos <= 0 ? 0 : static_cast<std::uint64_t>(nanos / TickNanos);
+            if (target <= nowTick_) return;
+            while (occupiedLevels_ != 0)
+            {
+                const unsigned level = std::countr_zero(occupiedLevels_);
+                const unsigned slot = std::countr_zero(occupied_[level]);
+                const std::uint64_t start = SlotStart(level, slot);
+                if (start > target) break;
+
+                nowTick_ = start;
+                std::uint32_t node = slots_[level][slot];
+                slots_[level][slot] = None;
+                MarkEmpty(level, slot);
+                while (node != None)
+                {
+                    const std::uint32_t next = nodes_[node].next_;
+                    if (nodes_[node].tick_ <= nowTick_) Retire(node, expire);
+                    else Place(node);
+                    node = next;
+                }
+            }
+            nowTick_ = target;
+        }
+
+        // Hands every GoodForDay order to `expire`, each forgotten before it is handed over.
+        template <typename Expire>
+        void CloseSession(Expire&& expire)
+        {
+            std::uint32_t node = sessionHead_;
+            sessionHead_ = None;
+            while (node != None)
+            {
+                const std::uint32_t next = nodes_[node].next_;
+                Retire(node, expire);
+                node = next;
+            }
+        }
+
+    private:
+        static constexpr unsigned Bits = 6;
+        static constexpr unsigned Slots = 1 << Bits;
+        static constexpr unsigned Levels = (64 + Bits - 1) / Bits;
+        static constexpr std::uint32_t None = std::numeric_limits<std::uint32_t>::max();
+        static constexpr std::uint64_t SessionTick = std::numeric_limits<std::uint64_t>::max();
+
+        struct Node
+        {
+            OrderPointer order_;
+            std::uint64_t tick_;   // deadline, or SessionTick for GoodForDay
+            std::uint32_t next_;
+            std::uint32_t prev_;
+        };
+
+        std::vector<Node> nodes_;
+        std::uint32_t freeHead_ { None };
+        std::size_t size_ { 0 };
+        std::array<std::array<std::uint32_t, Slots>, Levels> slots_ = MakeEmptySlots();
+        std::array<std::uint64_t, Levels> occupied_ {};
+        std::uint32_t occupiedLevels_ { 0 };
+        std::uint32_t sessionHead_ { None };
+        std::uint64_t nowTick_ { 0 };
+
+        static constexpr std::array<std::array<std::uint32_t, Slots>, Levels> MakeEmptySlots()
+        {
+            std::array<std::array<std::uint32_t, Slots>, Levels> slots {};
+            for (auto& level : slots) level.fill(None);
+            return slots;
+        }
+
+        static std::uint64_t DeadlineTick(Timestamp deadline)
+        {
+            const auto nanos = deadline.time_since_epoch().count();
+            return nanos <= 0 ? 0 : (static_cast<std::uint64_t>(nanos) + TickNanos - 1) / TickNanos;
+        }
+
+        unsigned LevelOf(std::uint64_t tick) const { return (std::bit_width(tick ^ nowTick_) - 1) / Bits; }
+        static unsigned SlotOf(std::uint64_t tick, unsigned level) { return (tick >> (Bits * level)) & (Slots - 1); }
+
+        // First tick of `slot` on `level` in the clock's current turn of that level.
+        std::uint64_t SlotStart(unsigned level, unsigned slot) const
+        {
+            const unsigned shift = Bits * level;
+            const std::uint64_t turn = shift + Bits >= 64 ? 0 : nowTick_ >> (shift + Bits) << (shift + Bits);
+            return turn + (std::uint64_t { slot } << shift);
+        }
+
+        std::uint32_t Allocate(OrderPointer order, std::uint64_t tick)
+        {
+            std::uint32_t node = freeHead_;
+            if (node != None) freeHead_ = nodes_[node].next_;
+            else
+            {
+                node = static_cast<std::uint32_t>(nodes_.size());
+                nodes_.emplace_back();
+            }
+            nodes_[node] = Node { order, tick, None, None };
+            ++size_;
+            return node;
+        }
+
+        void Free(std::uint32_t node)
+        {
+            nodes_[node].next_ = freeHead_;
+            freeHead_ = node;
+            --size_;
+        }
+
+        void Link(std::uint32_t& head, std::uint32_t node)
+        {
+            nodes_[node].prev_ = None;
+            nodes_[node].next_ = head;
+            if (head != None) nodes_[head].prev_ = node;
+            head = node;
+        }
+
+        void Place(std::uint32_t node)
+        {
+            const std::uint64_t tick = nodes_[node].tick_;
+            const unsigned level = LevelOf(tick);
+            const unsigned slot = SlotOf(tick, level);
+            Link(slots_[level][slot], node);
+            occupied_[level] |= std::uint64_t { 1 } << slot;
+            occupiedLevels_ |= 1u << level;
+        }
+
+        void MarkEmpty(unsigned level, unsigned slot)
+        {
+            occupied_[level] &= ~(std::uint64_t { 1 } << slot);
+            if (occupied_[level] == 0) occupiedLevels_ &= ~(1u << level);
+        }
+
+        // The clock never passes an occupied slot, so a wheel node's level and
+        // slot still follow from its deadline and the clock.
+        void Unlink(std::uint32_t node)
+        {
+            const Node& entry = nodes_[node];
+            if (entry.next_ != None) nodes_[entry.next_].prev_ = entry.prev_;
+            if (entry.prev_ != None)
+            {
+                nodes_[entry.prev_].next_ = entry.next_;
+                return;
+            }
+            if (entry.tick_ == SessionTick)
+            {
+                sessionHead_ = entry.next_;
+                return;
+            }
+            const unsigned level = LevelOf(entry.tick_);
+            const unsigned slot = SlotOf(entry.tick_, level);
+            slots_[level][slot] = entry.next_;
+            if (entry.next_ == None) MarkEmpty(level, slot);
+        }
+
+        template <typename Callback>
+        void Retire(std::uint32_t node, Callback& expire)
+        {
+            const OrderPointer order = nodes_[node].order_;
+            Free(node);
+            expire(order);
+        }
+};
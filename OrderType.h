@@ -1,10 +1,14 @@
 #pragma once
+#include <cstdint>
 
-enum class OrderType
+enum class OrderType : std::uint8_t
 {
     GoodTillCancel,
     FillAndKill,
     FillOrKill,
     GoodForDay,
-    Market
-};
\ No newline at end of file
+    Market,
+    GoodTillTime   // rests until its own expiry timestamp
+};
+// Types that can leave the book by the clock, and so have an entry in the book's OrderExpiry.
+constexpr bool HasExpiry(OrderType type) { return type == OrderType::GoodForDay || type == OrderType::GoodTillTime; }
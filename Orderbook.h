@@ -1,15 +1,23 @@
 #pragma once
-#include <map>
-#include <unordered_map>
 #include "Usings.h"
 #include "Order.h"
 #include "OrderModify.h"
 #include "OrderbookLevelInfos.h"
 #include "Trade.h"
+#include "TradeSink.h"
 #include <thread>
 #include <condition_variable>
 #include <mutex>
 #include "FixedSizePool.h"
+#include "LevelStorage.h"
+#include "PriceLevels.h"
+#include "FlatHashMap.h"
+#include "Concurrency.h"
+#include "BookView.h"
+#include "Seqlock.h"
+#include "Checkpoint.h"
+#include "OrderExpiry.h"
+#include <functional>
 
 
 
@@ -18,64 +26,146 @@ class OrderBook
 {
     private:
 
+        // An order with an expiry is held by its OrderExpiry handle instead, tagged
+        // in the low bit that Order's alignment leaves clear, so the expiry index
+        // needs no map of its own.
         struct OrderEntry
         {
-            OrderPointer order_ { nullptr };
-            OrderPointers::iterator location_;
-        };
+            std::uintptr_t value_ { 0 };
 
-        struct LevelData
-        {
-            Quantity quantity_ {};
-            Quantity count_ {};
-
-            enum class Action
-            {
-                Add,
-                Remove,
-                Match
-            };
+            static OrderEntry Untimed(OrderPointer order) { return { reinterpret_cast<std::uintptr_t>(order) }; }
+            static OrderEntry Timed(OrderExpiry::Handle handle) { return { std::uintptr_t { handle } << 1 | 1 }; }
+            bool HasExpiry() const { return value_ & 1; }
+            OrderExpiry::Handle Handle() const { return static_cast<OrderExpiry::Handle>(value_ >> 1); }
         };
 
-        std::unordered_map<Price, LevelData> data_;
-        std::map<Price, OrderPointers, std::greater<Price>> bids_;
-        std::map<Price, OrderPointers, std::less<Price>> asks_;
-        std::unordered_map<OrderId, OrderEntry> orders_;
+        MapLevels<Side::Buy> bids_;
+        MapLevels<Side::Sell> asks_;
+        PriceLadder<Side::Buy> bidLadder_;
+        PriceLadder<Side::Sell> askLadder_;
+        LevelStorage levelStorage_;
+        FlatHashMap<OrderId, OrderEntry> orders_;
+        OrderExpiry expiry_;
         mutable std::mutex ordersMutex_;
-        std::thread ordersPruneThread_;
-        std::condition_variable shutdownConditionVariable_;
+        std::condition_variable pruneConditionVariable_;
+        Timestamp pruneWakeAt_ { Timestamp::max() };   // when the prune thread next wakes, under ordersMutex_
         std::atomic<bool> shutdown_ { false };
         MemoryPool<Order>& orderPool_;
         bool useMempool_;
+        Concurrency concurrency_;
+        std::function<void()> onGoodForDayClose_;
+        std::atomic<std::size_t> publishedSize_ { 0 };
+        Seqlock<BookView> view_;
+        Seqlock<BookView>* viewMirror_ { nullptr };
+        std::thread ordersPruneThread_;
 
-        void CancelOrders(OrderIds orderIds);
-        void CancelOrderInternal(OrderId orderId);
+        template <typename Visitor>
+        decltype(auto) VisitLevels(Visitor&& visitor)
+        {
+            if (levelStorage_ == LevelStorage::Ladder) return visitor(bidLadder_, askLadder_);
+            return visitor(bids_, asks_);
+        }
+        template <typename Visitor>
+        decltype(auto) VisitLevels(Visitor&& visitor) const
+        {
+            if (levelStorage_ == LevelStorage::Ladder) return visitor(bidLadder_, askLadder_);
+            return visitor(bids_, asks_);
+        }
 
-        void OnOrderCancelled(OrderPointer order);
-        void OnOrderAdded(OrderPointer order);
-        void OnOrderMatched(Price price, Quantity quantity, bool isFullyFilled);
-        void UpdateLevelData(Price price, Quantity quantity, LevelData::Action action);
+        std::unique_lock<std::mutex> LockOrders() const
+        {
+            if (concurrency_ == Concurrency::SingleWriter) return {};
+            return std::unique_lock { ordersMutex_ };
+        }
+        void PublishSize() { publishedSize_.store(orders_.size(), std::memory_order_release); }
+        OrderPointer OrderOf(OrderEntry entry) const
+        {
+            return entry.HasExpiry() ? expiry_.OrderOf(entry.Handle()) : reinterpret_cast<OrderPointer>(entry.value_);
+        }
+        OrderEntry Track(OrderPointer order, Timestamp expiry);
 
-        bool CanFullyFill(Side side, Price price, Quantity quantity) const;
-        bool CanMatch(Side side, Price price) const;
-        Trades MatchOrders();
-        void PruneGoodForDay();
+        void CancelOrderInternal(OrderId orderId);
+        template <typename Bids, typename Asks>
+        void CancelOrderInternal(Bids& bids, Asks& asks, OrderId orderId);
+        template <typename Bids, typename Asks>
+        void RemoveOrder(Bids& bids, Asks& asks, OrderPointer order, bool changeDepth = true);
+
+        template <typename Bids, typename Asks>
+        bool CanFullyFill(const Bids& bids, const Asks& asks, Side side, Price price, Quantity quantity) const;
+        template <typename Bids, typename Asks>
+        bool CanMatch(const Bids& bids, const Asks& asks, Side side, Price price) const;
+        template <typename Bids, typename Asks, typename Sink>
+        void AddOrder(Bids& bids, Asks& asks, OrderPointer order, Sink& sink, Timestamp expiry);
+        template <typename Levels, typename Sink>
+        void Sweep(Levels& levels, OrderPointer order, Sink& sink);
+        template <typename Levels>
+        static void CaptureLevels(const Levels& levels, std::vector<CheckpointLevel>& out, std::vector<CheckpointOrder>& orders);
+        template <typename Levels>
+        const CheckpointOrder* RestoreLevels(Levels& levels, Side side, std::span<const CheckpointLevel> records,
+            const CheckpointOrder* orders, const CheckpointOrder* last, std::span<const std::int64_t>& deadlines);
+        void PruneExpiredOrders();
         void DestroyOrder(OrderPointer order);
 
     public:
 
-        OrderBook(MemoryPool<Order>& pool, bool use_mempool);
+        // In SingleWriter mode only the owning thread may call the mutating members,
+        // GetOrderInfos and GetDepth; nothing on that path locks. Other threads read Size() and
+        // GetView(). At the GoodForDay close the timer calls onGoodForDayClose (which
+        // should hand CancelGoodForDayOrders() to the owning thread) instead of
+        // cancelling itself, and good-till-time orders expire only when the owning
+        // thread calls ExpireOrders. In Locked mode the timer does both itself.
+        OrderBook(MemoryPool<Order>& pool, bool use_mempool, LevelStorage levels = LevelStorage::Map,
+            Concurrency concurrency = Concurrency::Locked, std::function<void()> onGoodForDayClose = {});
         OrderBook(const OrderBook&) = delete;
         void operator=(const OrderBook&) = delete;
         OrderBook(const OrderBook&&) = delete;
         void operator=(const OrderBook&&) = delete;
         ~OrderBook();
 
-        Trades AddOrder(OrderPointer order);
+        // `expiry` is read only for GoodTillTime orders, which rest until then; one
+        // whose expiry has already passed (see ExpireOrders) is rejected unmatched.
+        // A modified order keeps its expiry.
+        Trades AddOrder(OrderPointer order, Timestamp expiry = {});
         void CancelOrder(OrderId orderId);
         Trades ModifyOrder(OrderModify order);
 
+        // As above, but every execution is handed to `sink` as it happens instead of
+        // being collected. Instantiated in orderbook.cpp for the sinks in TradeSink.h.
+        template <typename Sink>
+        void AddOrder(OrderPointer order, Sink sink, Timestamp expiry = {});
+        template <typename Sink>
+        void ModifyOrder(OrderModify order, Sink sink);
+
+        // Both cost O(orders expired): timed orders are indexed as they rest.
+        void CancelGoodForDayOrders();
+        // Cancels every GoodTillTime order whose expiry is at or before `now`, to the millisecond.
+        void ExpireOrders(Timestamp now);
+        // No GoodTillTime order expires before this (Timestamp::max() if none rests), so the
+        // owning thread only needs to call ExpireOrders once its clock reaches it.
+        Timestamp NextExpiry() const;
+
+        // Copies every resting order into `checkpoint`, level by level and in queue
+        // order, reusing its capacity; key_ and applied_ are the caller's to fill.
+        // It reads the book like GetDepth does, so in SingleWriter mode only the
+        // owning thread may take one, between commands.
+        void Checkpoint(BookCheckpoint& checkpoint) const;
+        // Loads a checkpoint into this book, which must be empty. Orders go straight
+        // into pool slots and onto their levels in queue order, without matching.
+        // Throws on a duplicate order id or a malformed checkpoint, leaving what
+        // was loaded so far in the book.
+        void Restore(const CheckpointView& checkpoint);
+
         std::size_t Size() const;
         OrderBookLevelInfos GetOrderInfos() const;
+        // Best `levels` price levels per side, best first, into the caller's buffers.
+        // Costs O(levels) off the per-level aggregates and reuses the buffers'
+        // capacity, so a caller that keeps them around does not allocate.
+        void GetDepth(std::size_t levels, LevelInfos& bids, LevelInfos& asks) const;
+        void PublishView();
+        BookView GetView() const { return view_.Load(); }
+        // PublishView also stores every view into `mirror` (e.g. a shared-memory
+        // feed), which then has the book's writer as its only writer. Set it before
+        // the first publish; nullptr stops mirroring.
+        void MirrorViewTo(Seqlock<BookView>* mirror) { viewMirror_ = mirror; }
 
 };
\ No newline at end of file
@@ -0,0 +1,313 @@
+#pragma once
+#include <bit>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <format>
+#include "Usings.h"
+#include "Side.h"
+#include "Order.h"
+
+// Both level containers expose the same interface so the matching code in
+// orderbook.cpp can be written once and instantiated for either backend.
+// Iteration and the "best" level always follow the side's priority:
+// highest price first for bids, lowest price first for asks.
+// ForEachLevel stops early when the visitor returns false. CanHold(price) says
+// whether GetLevel(price) would succeed, so an order is never matched only to
+// find it cannot rest.
+//
+// HasDepth(limit, quantity) answers the FillOrKill question: do the levels
+// priced at limit or better hold at least quantity? The book reports every
+// change to a level's total through ChangeDepth, which is what lets the ladder
+// answer it without a walk, or else calls RebuildDepth once it is done.
+
+template <typename Visitor>
+bool VisitLevel(Visitor& visitor, Price price, const OrderPointers& orders)
+{
+    if constexpr (std::is_void_v<std::invoke_result_t<Visitor&, Price, const OrderPointers&>>)
+    {
+        visitor(price, orders);
+        return true;
+    }
+    else return visitor(price, orders);
+}
+
+template <Side S>
+class MapLevels
+{
+    public:
+        bool Empty() const { return levels_.empty(); }
+        Price BestPrice() const { return levels_.begin()->first; }
+        OrderPointers& BestLevel() { return levels_.begin()->second; }
+        const OrderPointers& BestLevel() const { return levels_.begin()->second; }
+        Price WorstPrice() const { return levels_.rbegin()->first; }
+
+        bool CanHold(Price) const { return true; }
+        OrderPointers& GetLevel(Price price) { return levels_[price]; }
+        OrderPointers& At(Price price) { return levels_.at(price); }
+        void Erase(Price price) { levels_.erase(price); }
+
+        // The map keeps no running depth: HasDepth walks from the best level
+        // and stops at the limit or once it has seen enough.
+        void ChangeDepth(Price, std::int64_t) {}
+        void RebuildDepth() {}
+        bool HasDepth(Price limit, Quantity quantity) const
+        {
+            std::uint64_t depth = 0;
+            for (const auto& [price, orders] : levels_)
+            {
+                if (Compare {}(limit, price)) return false;
+                depth += orders.quantity();
+                if (depth >= quantity) return true;
+            }
+            return false;
+        }
+
+        template <typename Visitor>
+        void ForEachLevel(Visitor&& visitor) const
+        {
+            for (const auto& [price, orders] : levels_)
+            {
+                if (!VisitLevel(visitor, price, orders)) return;
+            }
+        }
+
+    private:
+        using Compare = std::conditional_t<S == Side::Buy, std::greater<Price>, std::less<Price>>;
+        std::map<Price, OrderPointers, Compare> levels_;
+};
+
+// Contiguous, tick-indexed price levels for instruments trading in a bounded band.
+// A level lives at index (price - base_); an occupancy bitmap and a cursor on the
+// best index give O(1) top-of-book, and finding the next best level after the top
+// one empties is a word-at-a-time bitmap scan. Prices outside the window trigger a
+// recenter that moves the live levels into a (possibly larger) window.
+//
+// A Fenwick tree over the same indices holds cumulative level quantities, so
+// the quantity resting at or better than any price is a prefix sum: HasDepth
+// and each ChangeDepth cost O(log ticks) however deep the book is.
+template <Side S>
+class PriceLadder
+{
+    public:
+        static constexpr std::size_t DefaultTicks = 1 << 12;
+        static constexpr std::size_t MaxTicks = 1 << 22;
+
+        explicit PriceLadder(std::size_t ticks = DefaultTicks):
+        ticks_ { std::bit_ceil(ticks < 64 ? std::size_t{64} : ticks) }
+        {}
+
+        bool Empty() const { return count_ == 0; }
+        Price BestPrice() const { return ToPrice(best_); }
+        OrderPointers& BestLevel() { return levels_[best_]; }
+        const OrderPointers& BestLevel() const { return levels_[best_]; }
+        Price WorstPrice() const
+        {
+            return ToPrice(S == Side::Buy ? FindAtOrAbove(0) : FindAtOrBelow(levels_.size() - 1));
+        }
+
+        // False if making room for `price` would take a window of more than MaxTicks.
+        bool CanHold(Price price) const
+        {
+            if (Contains(price)) return true;
+            const auto [low, high] = BoundsWith(price);
+            return static_cast<std::uint64_t>(high - low + 1) * 2 <= MaxTicks;
+        }
+
+        OrderPointers& GetLevel(Price price)
+        {
+            if (!Contains(price)) Recenter(price);
+
+            const std::size_t index = ToIndex(price);
+            if (!IsOccupied(index))
+            {
+                occupied_[index >> 6] |= Bit(index);
+                if (count_++ == 0 || IsBetter(index, best_)) best_ = index;
+            }
+            return levels_[index];
+        }
+
+        OrderPointers& At(Price price)
+        {
+            if (!Contains(price) || !IsOccupied(ToIndex(price)))
+                throw std::out_of_range(std::format("Price level ({}) does not exist.", price));
+            return levels_[ToIndex(price)];
+        }
+
+        void Erase(Price price)
+        {
+            if (!Contains(price)) return;
+            const std::size_t index = ToIndex(price);
+            if (!IsOccupied(index)) return;
+
+            levels_[index].clear();
+            occupied_[index >> 6] &= ~Bit(index);
+            if (--count_ == 0 || index != best_) return;
+
+            best_ = S == Side::Buy ? FindAtOrBelow(index) : FindAtOrAbove(index);
+        }
+
+        // `delta` is the change in the total at `price`, which must be a level.
+        void ChangeDepth(Price price, std::int64_t delta)
+        {
+            const auto change = static_cast<std::uint64_t>(delta);
+            depth_ += change;
+            for (std::size_t node = ToIndex(price) + 1; node <= depthTree_.size(); node += node & (~node + 1))
+                depthTree_[node - 1] += change;
+        }
+
+        // Lays the level totals out as a Fenwick tree in one pass: each node
+        // passes its sum up to its parent.
+        void RebuildDepth()
+        {
+            depthTree_.assign(levels_.size(), 0);
+            depth_ = 0;
+            for (std::size_t node = 1; node <= depthTree_.size(); ++node)
+            {
+                depth_ += levels_[node - 1].quantity();
+                depthTree_[node - 1] += levels_[node - 1].quantity();
+                const std::size_t parent = node + (node & (~node + 1));
+                if (parent <= depthTree_.size()) depthTree_[parent - 1] += depthTree_[node - 1];
+            }
+        }
+
+        bool HasDepth(Price limit, Quantity quantity) const
+        {
+            if (depth_ < quantity) return false;
+            // Asks at or below the limit are the first limit - base_ + 1 indices;
+            // bids at or above it are everything past the first limit - base_.
+            std::int64_t below = limit - base_ + (S == Side::Sell ? 1 : 0);
+            below = std::clamp<std::int64_t>(below, 0, static_cast<std::int64_t>(depthTree_.size()));
+            const std::uint64_t prefix = DepthBefore(static_cast<std::size_t>(below));
+            return (S == Side::Sell ? prefix : depth_ - prefix) >= quantity;
+        }
+
+        template <typename Visitor>
+        void ForEachLevel(Visitor&& visitor) const
+        {
+            if (Empty()) return;
+            if constexpr (S == Side::Buy)
+            {
+                for (std::size_t index = best_; ; --index)
+                {
+                    index = FindAtOrBelow(index);
+                    if (index == npos || !VisitLevel(visitor, ToPrice(index), levels_[index])) break;
+                    if (index == 0) break;
+                }
+            }
+            else
+            {
+                for (std::size_t index = best_; index < levels_.size(); ++index)
+                {
+                    index = FindAtOrAbove(index);
+                    if (index == npos || !VisitLevel(visitor, ToPrice(index), levels_[index])) break;
+                }
+            }
+        }
+
+    private:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        std::vector<OrderPointers> levels_;
+        std::vector<std::uint64_t> occupied_;
+        std::vector<std::uint64_t> depthTree_;   // Fenwick tree: node i sums the i & -i levels ending at index i - 1
+        std::uint64_t depth_ {};                  // total quantity on the side
+        std::int64_t base_ {};
+        std::size_t best_ {};
+        std::size_t count_ {};
+        std::size_t ticks_;
+
+        static std::uint64_t Bit(std::size_t index) { return std::uint64_t{1} << (index & 63); }
+        static bool IsBetter(std::size_t index, std::size_t than) { return S == Side::Buy ? index > than : index < than; }
+
+        bool Contains(Price price) const
+        {
+            return !levels_.empty() && price >= base_ && price - base_ < static_cast<std::int64_t>(levels_.size());
+        }
+        std::size_t ToIndex(Price price) const { return static_cast<std::size_t>(price - base_); }
+        Price ToPrice(std::size_t index) const { return static_cast<Price>(base_ + static_cast<std::int64_t>(index)); }
+        bool IsOccupied(std::size_t index) const { return occupied_[index >> 6] & Bit(index); }
+
+        // Total quantity of the levels at indices [0, count).
+        std::uint64_t DepthBefore(std::size_t count) const
+        {
+            std::uint64_t sum = 0;
+            for (std::size_t node = count; node > 0; node &= node - 1) sum += depthTree_[node - 1];
+            return sum;
+        }
+
+        std::size_t FindAtOrAbove(std::size_t index) const
+        {
+            std::size_t word = index >> 6;
+            std::uint64_t bits = occupied_[word] & (~std::uint64_t{0} << (index & 63));
+            while (bits == 0)
+            {
+                if (++word == occupied_.size()) return npos;
+                bits = occupied_[word];
+            }
+            return (word << 6) + std::countr_zero(bits);
+        }
+
+        std::size_t FindAtOrBelow(std::size_t index) const
+        {
+            std::size_t word = index >> 6;
+            std::uint64_t bits = occupied_[word] & (~std::uint64_t{0} >> (63 - (index & 63)));
+            while (bits == 0)
+            {
+                if (word-- == 0) return npos;
+                bits = occupied_[word];
+            }
+            return (word << 6) + 63 - std::countl_zero(bits);
+        }
+
+        // Lowest and highest price among the live levels and `price`.
+        std::pair<std::int64_t, std::int64_t> BoundsWith(Price price) const
+        {
+            std::int64_t low = price;
+            std::int64_t high = price;
+            if (!Empty())
+            {
+                low = std::min<std::int64_t>(low, ToPrice(FindAtOrAbove(0)));
+                high = std::max<std::int64_t>(high, ToPrice(FindAtOrBelow(levels_.size() - 1)));
+            }
+            return { low, high };
+        }
+
+        void Recenter(Price price)
+        {
+            const auto [low, high] = BoundsWith(price);
+
+            std::size_t ticks = std::max(ticks_, levels_.size());
+            const auto span = static_cast<std::size_t>(high - low + 1);
+            while (ticks < span * 2)
+            {
+                if (ticks >= MaxTicks)
+                    throw std::length_error(std::format("Price ({}) is outside the ladder's maximum tick band.", price));
+                ticks *= 2;
+            }
+
+            std::vector<OrderPointers> levels(ticks);
+            std::vector<std::uint64_t> occupied(ticks / 64);
+            const std::int64_t base = low + (high - low) / 2 - static_cast<std::int64_t>(ticks / 2);
+
+            for (std::size_t word = 0; word < occupied_.size(); ++word)
+            {
+                for (std::uint64_t bits = occupied_[word]; bits != 0; bits &= bits - 1)
+                {
+                    const std::size_t from = (word << 6) + std::countr_zero(bits);
+                    const auto to = static_cast<std::size_t>(base_ + static_cast<std::int64_t>(from) - base);
+                    levels[to].swap(levels_[from]);
+                    occupied[to >> 6] |= Bit(to);
+                }
+            }
+
+            if (!Empty()) best_ = static_cast<std::size_t>(base_ + static_cast<std::int64_t>(best_) - base);
+            levels_.swap(levels);
+            occupied_.swap(occupied);
+            base_ = base;
+            RebuildDepth();
+        }
+};
@@ -1,11 +1,19 @@
 #pragma once
+#include <algorithm>
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <format>
 #pragma pack(push, 1)
 
+// Frames are the packed structs below, back to back on the stream. The first
+// byte of every frame is its MessageType, which fixes the frame's length.
 enum class  MessageType : uint8_t
 {
     NewOrder = 1,
-    CancelOrder = 2
+    CancelOrder = 2,
+    ModifyOrder = 3
 };
 
 struct NewOrderMsg
@@ -17,12 +25,108 @@ struct NewOrderMsg
     uint32_t quantity;
     uint8_t side;
     char symbol[8];
+    uint8_t order_type; // OrderType; 0 is GoodTillCancel
+    uint64_t expiry;    // GoodTillTime deadline in ns since the Unix epoch; ignored for other types
 };
 
-struct CancelOrder
+struct CancelOrderMsg
 {
     MessageType type;
+    uint64_t timestamp;
+    uint64_t order_id;
+    char symbol[8];
+};
+
+// Replaces a resting order's side, price and quantity (OrderBook::ModifyOrder); it loses time priority.
+struct ModifyOrderMsg
+{
+    MessageType type;
+    uint64_t timestamp;
     uint64_t order_id;
+    uint32_t price;
+    uint32_t quantity;
+    uint8_t side;
+    char symbol[8];
 };
 
-#pragma pack(pop)
\ No newline at end of file
+#pragma pack(pop)
+
+// Length of the frame starting with `type`, or 0 if the type is unknown.
+inline std::size_t FrameSize(MessageType type)
+{
+    switch (type)
+    {
+        case MessageType::NewOrder: return sizeof(NewOrderMsg);
+        case MessageType::CancelOrder: return sizeof(CancelOrderMsg);
+        case MessageType::ModifyOrder: return sizeof(ModifyOrderMsg);
+    }
+    return 0;
+}
+
+// Hands every complete frame in [data, data + size) to `handler` as a typed
+// reference into the buffer itself, and returns the bytes consumed; a partial
+// frame at the end is left for the next read. An unknown type byte means the
+// stream has lost framing, which cannot be recovered, so it throws.
+template <typename Handler>
+std::size_t DecodeFrames(const char* data, std::size_t size, Handler&& handler)
+{
+    std::size_t offset = 0;
+    while (offset < size)
+    {
+        const auto type = static_cast<MessageType>(data[offset]);
+        const std::size_t frame = FrameSize(type);
+        if (frame == 0)
+            throw std::runtime_error(std::format("Unknown message type ({}) at offset {}.", static_cast<int>(type), offset));
+        if (size - offset < frame) break;
+
+        const char* message = data + offset;
+        switch (type)
+        {
+            case MessageType::NewOrder: handler(*reinterpret_cast<const NewOrderMsg*>(message)); break;
+            case MessageType::CancelOrder: handler(*reinterpret_cast<const CancelOrderMsg*>(message)); break;
+            case MessageType::ModifyOrder: handler(*reinterpret_cast<const ModifyOrderMsg*>(message)); break;
+        }
+        offset += frame;
+    }
+    return offset;
+}
+
+// Decodes a stream that arrives in buffers the caller must hand back right
+// away, such as io_uring's kernel-provided receive buffers: whole frames are
+// decoded in place, and only a frame split across two buffers is copied, into
+// a carry of at most one frame.
+class FrameReassembler
+{
+    public:
+        static constexpr std::size_t MaxFrame = 64;
+
+        template <typename Handler>
+        void Consume(const char* data, std::size_t size, Handler&& handler)
+        {
+            if (carried_ > 0)
+            {
+                // DecodeFrames only leaves a partial frame whose type it knows.
+                const std::size_t frame = FrameSize(static_cast<MessageType>(carry_[0]));
+                const std::size_t take = std::min(frame - carried_, size);
+                std::memcpy(carry_ + carried_, data, take);
+                carried_ += take;
+                data += take;
+                size -= take;
+                if (carried_ < frame) return;
+                DecodeFrames(carry_, frame, handler);
+                carried_ = 0;
+            }
+            const std::size_t consumed = DecodeFrames(data, size, handler);
+            carried_ = size - consumed;
+            std::memcpy(carry_, data + consumed, carried_);
+        }
+
+        // Bytes of a partial frame waiting for the next buffer.
+        std::size_t Carried() const { return carried_; }
+
+    private:
+        char carry_[MaxFrame];
+        std::size_t carried_ = 0;
+};
+static_assert(sizeof(NewOrderMsg) <= FrameReassembler::MaxFrame && sizeof(CancelOrderMsg) <= FrameReassembler::MaxFrame &&
+              sizeof(ModifyOrderMsg) <= FrameReassembler::MaxFrame, "FrameReassembler's carry must hold any frame");
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// Single-writer sequence lock. The writer bumps the sequence to odd, copies the
+// value in and bumps it back to even, using only plain stores; readers copy the
+// value out and retry if the sequence moved underneath them. Readers never block
+// the writer, and the writer never performs an atomic read-modify-write.
+template <typename T>
+class Seqlock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Seqlock values are copied byte-wise");
+
+    public:
+        void Store(const T& value)
+        {
+            const std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+            sequence_.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(&value_, &value, sizeof(T));
+            sequence_.store(sequence + 2, std::memory_order_release);
+        }
+
+        T Load() const
+        {
+            T value;
+            while (true)
+            {
+                const std::uint64_t before = sequence_.load(std::memory_order_acquire);
+                if (before & 1)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::memcpy(&value, &value_, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence_.load(std::memory_order_relaxed) == before) return value;
+            }
+        }
+
+    private:
+        alignas(64) std::atomic<std::uint64_t> sequence_ { 0 };
+        alignas(64) T value_ {};
+};
@@ -1,6 +1,7 @@
 #pragma once
+#include <cstdint>
 
-enum class Side
+enum class Side : std::uint8_t
 {
     Buy,
     Sell
@@ -0,0 +1,141 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+// Bounded single-producer / single-consumer ring. Each side owns one index and
+// keeps a private copy of the other side's index, so it only touches the shared
+// cache line when its copy says the ring looks full (producer) or empty
+// (consumer). Indices run freely and are masked into the power-of-two buffer.
+template <typename T, std::size_t Capacity>
+class SpscRing
+{
+    static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "Ring items are copied byte-wise");
+
+    public:
+        bool try_push(const T& item) { return try_push_n(&item, 1) == 1; }
+
+        // Pushes up to `count` items and returns how many fit.
+        std::size_t try_push_n(const T* items, std::size_t count)
+        {
+            const std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (Capacity - (tail - cachedHead_) < count) cachedHead_ = head_.load(std::memory_order_acquire);
+
+            count = std::min(count, Capacity - (tail - cachedHead_));
+            for (std::size_t i = 0; i < count; ++i) buffer_[(tail + i) & Mask] = items[i];
+            tail_.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        // Pops up to `max` items into `items` and returns how many were taken.
+        std::size_t try_pop_n(T* items, std::size_t max)
+        {
+            const std::size_t head = head_.load(std::memory_order_relaxed);
+            if (cachedTail_ - head < max) cachedTail_ = tail_.load(std::memory_order_acquire);
+
+            const std::size_t count = std::min(max, cachedTail_ - head);
+            for (std::size_t i = 0; i < count; ++i) items[i] = buffer_[(head + i) & Mask];
+            head_.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+    private:
+        static constexpr std::size_t Mask = Capacity - 1;
+
+        alignas(64) std::atomic<std::size_t> head_ { 0 };
+        alignas(64) std::size_t cachedTail_ { 0 };
+        alignas(64) std::atomic<std::size_t> tail_ { 0 };
+        alignas(64) std::size_t cachedHead_ { 0 };
+        alignas(64) std::array<T, Capacity> buffer_;
+};
+
+// One SPSC ring per producer, all drained by a single consumer. Producers claim
+// a ring once per connection (the only place a lock is taken) and hand it back
+// when done; the consumer recycles a released ring once it has drained it.
+template <typename T, std::size_t Capacity, std::size_t MaxProducers>
+class SpscRingSet
+{
+    public:
+        using Ring = SpscRing<T, Capacity>;
+
+        // Blocks until a ring is free.
+        Ring* Acquire()
+        {
+            while (true)
+            {
+                {
+                    std::scoped_lock lock { mutex_ };
+                    for (std::size_t i = 0; i < MaxProducers; ++i)
+                    {
+                        Slot& slot = slots_[i];
+                        if (slot.state_.load(std::memory_order_acquire) != State::Free) continue;
+
+                        if (!slot.ring_) slot.ring_ = std::make_unique<Ring>();
+                        slot.state_.store(State::Active, std::memory_order_release);
+                        if (i >= used_.load(std::memory_order_relaxed)) used_.store(i + 1, std::memory_order_release);
+                        return slot.ring_.get();
+                    }
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        void Release(Ring* ring)
+        {
+            std::scoped_lock lock { mutex_ };
+            for (auto& slot : slots_)
+            {
+                if (slot.ring_.get() == ring) slot.state_.store(State::Closing, std::memory_order_release);
+            }
+        }
+
+        // Consumer side: pops up to `batchSize` items from every live ring into
+        // `batch`, hands each to `handler`, and returns the total handled.
+        template <typename Handler>
+        std::size_t Drain(T* batch, std::size_t batchSize, Handler&& handler)
+        {
+            std::size_t drained = 0;
+            const std::size_t used = used_.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < used; ++i)
+            {
+                Slot& slot = slots_[i];
+                const State state = slot.state_.load(std::memory_order_acquire);
+                if (state == State::Free) continue;
+
+                const std::size_t count = slot.ring_->try_pop_n(batch, batchSize);
+                for (std::size_t j = 0; j < count; ++j) handler(batch[j]);
+                drained += count;
+
+                if (count == 0 && state == State::Closing) slot.state_.store(State::Free, std::memory_order_release);
+            }
+            return drained;
+        }
+
+    private:
+        enum class State : std::uint8_t
+        {
+            Free,
+            Active,
+            Closing
+        };
+
+        struct Slot
+        {
+            std::atomic<State> state_ { State::Free };
+            std::unique_ptr<Ring> ring_;
+        };
+
+        std::mutex mutex_;
+        std::atomic<std::size_t> used_ { 0 };
+        std::array<Slot, MaxProducers> slots_;
+};
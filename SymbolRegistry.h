@@ -0,0 +1,110 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <format>
+#include "Orderbook.h"
+#include "FixedSizePool.h"
+
+// The wire carries symbols as 8 zero-padded bytes; reinterpreted as one
+// integer they compare in a single instruction.
+using SymbolKey = std::uint64_t;
+
+inline SymbolKey ToSymbolKey(const char (&symbol)[8])
+{
+    SymbolKey key;
+    std::memcpy(&key, symbol, sizeof(key));
+    return key;
+}
+
+inline SymbolKey ToSymbolKey(std::string_view symbol)
+{
+    if (symbol.empty() || symbol.size() > sizeof(SymbolKey))
+        throw std::invalid_argument(std::format("Symbol ({}) must be 1 to 8 characters.", symbol));
+    char padded[8] = {};
+    std::memcpy(padded, symbol.data(), symbol.size());
+    return ToSymbolKey(padded);
+}
+
+// Spreads symbols over engine shards. The multiply mixes every byte of the key
+// into the high bits, which plain modulo of the ASCII bytes would not.
+inline std::size_t ShardOf(SymbolKey key, std::size_t shards)
+{
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) % shards;
+}
+
+// Everything one instrument owns. Instruments share nothing, so their books
+// and pools never contend with each other.
+struct Instrument
+{
+    SymbolKey key_ {};
+    std::string name_;
+    std::size_t shard_ {};
+    std::size_t index_ {}; // position in the registry
+    std::unique_ptr<MemoryPool<Order>> pool_;
+    std::unique_ptr<OrderBook> book_;
+    std::atomic<std::uint64_t> processed_ { 0 };
+    // Commands applied to the book, housekeeping ones included, counted the way
+    // the journal records them. Only the owning engine thread (or start-up
+    // recovery) touches it; a checkpoint keeps it, so replay can skip the
+    // symbol's records the checkpoint already holds.
+    std::uint64_t applied_ = 0;
+};
+
+// Fixed set of instruments, registered before any traffic flows. Lookups scan a
+// contiguous array of keys, which beats hashing for the handful of symbols a
+// book server carries.
+class SymbolRegistry
+{
+    public:
+        static constexpr std::size_t MaxSymbols = 64;
+        using BookFactory = std::function<std::unique_ptr<OrderBook>(MemoryPool<Order>&, SymbolKey)>;
+
+        Instrument& Add(std::string_view symbol, std::size_t poolCapacity, const BookFactory& makeBook)
+        {
+            return Add(symbol, poolCapacity, PoolOptions {}, makeBook);
+        }
+
+        Instrument& Add(std::string_view symbol, std::size_t poolCapacity, PoolOptions poolOptions, const BookFactory& makeBook)
+        {
+            const SymbolKey key = ToSymbolKey(symbol);
+            if (Find(key) != nullptr)
+                throw std::invalid_argument(std::format("Symbol ({}) is already registered.", symbol));
+            if (instruments_.size() == MaxSymbols)
+                throw std::length_error(std::format("Cannot register more than {} symbols.", MaxSymbols));
+
+            auto instrument = std::make_unique<Instrument>();
+            instrument->key_ = key;
+            instrument->name_ = symbol;
+            instrument->index_ = instruments_.size();
+            instrument->pool_ = std::make_unique<MemoryPool<Order>>(poolCapacity, poolOptions);
+            instrument->book_ = makeBook(*instrument->pool_, key);
+
+            keys_[instruments_.size()] = key;
+            instruments_.push_back(std::move(instrument));
+            return *instruments_.back();
+        }
+
+        Instrument* Find(SymbolKey key) const
+        {
+            for (std::size_t i = 0; i < instruments_.size(); ++i)
+            {
+                if (keys_[i] == key) return instruments_[i].get();
+            }
+            return nullptr;
+        }
+
+        std::size_t Size() const { return instruments_.size(); }
+        Instrument& operator[](std::size_t index) const { return *instruments_[index]; }
+
+    private:
+        std::array<SymbolKey, MaxSymbols> keys_ {};
+        std::vector<std::unique_ptr<Instrument>> instruments_;
+};
@@ -6,6 +6,7 @@
 class Trade
 {
     public:
+        Trade() = default;
         Trade(const TradeInfo& bidTrade, const TradeInfo& askTrade):
         bidTrade_ (bidTrade),
         askTrade_ (askTrade)
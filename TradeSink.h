@@ -0,0 +1,55 @@
+#pragma once
+#include <thread>
+#include "Trade.h"
+#include "SpscRing.h"
+
+// Destinations for the executions matching produces. OrderBook's sink overloads
+// are compiled once per sink type, so the call is inlined and NullTradeSink
+// costs nothing. Sinks are passed by value; the ones that keep state hold a
+// reference to it.
+
+struct NullTradeSink
+{
+    void operator()(const Trade&) const {}
+};
+
+// Appends to a vector; backs the Trades-returning API.
+struct TradeCollector
+{
+    Trades& trades_;
+
+    void operator()(const Trade& trade) const { trades_.push_back(trade); }
+};
+
+// Preallocated hand-off of executions to another thread (drop copy, market
+// data). An execution is never dropped: when the ring is full, matching waits
+// for the consumer.
+using TradeRing = SpscRing<Trade, 1 << 16>;
+
+struct TradeRingSink
+{
+    TradeRing& ring_;
+
+    void operator()(const Trade& trade) const
+    {
+        while (!ring_.try_push(trade)) std::this_thread::yield();
+    }
+};
+
+// Any other listener, at the price of one indirect call per execution. The
+// listener must outlive the call it is passed to.
+class TradeCallback
+{
+    public:
+        template <typename Listener>
+        explicit TradeCallback(Listener& listener):
+        context_ { &listener },
+        call_ { [](void* context, const Trade& trade) { (*static_cast<Listener*>(context))(trade); } }
+        {}
+
+        void operator()(const Trade& trade) const { call_(context_, trade); }
+
+    private:
+        void* context_;
+        void (*call_)(void*, const Trade&);
+};
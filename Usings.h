@@ -1,8 +1,12 @@
 #pragma once
+#include <chrono>
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 using Price = std::int32_t;
 using Quantity = std::uint32_t;
 using OrderId = std::uint64_t;
 using OrderIds = std::vector<OrderId>;
+constexpr OrderId ReservedOrderId = std::numeric_limits<OrderId>::max(); // the order index's empty-slot marker, never a real order
+using Timestamp = std::chrono::sys_time<std::chrono::nanoseconds>; // wall clock, as carried by good-till-time orders
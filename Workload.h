@@ -0,0 +1,215 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <format>
+#include "EngineCommand.h"
+#include "Side.h"
+#include "Usings.h"
+
+// Synthetic order flow for replay benchmarks. A workload is a flat array of
+// EngineCommands (the engine's own inbound format), so a replay is a straight
+// walk over memory. NewOrderMsg::timestamp carries the Poisson arrival time in
+// nanoseconds from the start of the run.
+//
+// Generation is seeded and deterministic for a given standard library. The
+// distributions are the library's own, so keep the file rather than the seed
+// when comparing across toolchains.
+struct WorkloadSpec
+{
+    std::string name_;
+    std::uint64_t seed_ = 1;
+    std::size_t commands_ = 2'000'000;
+    std::size_t preload_ = 100'000;     // passive orders laid down before the mix starts
+
+    double addWeight_ = 0.6;
+    double cancelWeight_ = 0.3;
+    double modifyWeight_ = 0.1;
+
+    double arrivalsPerSecond_ = 1'000'000;
+    Price startMid_ = 100'000;
+    double driftPerEvent_ = 0.01;       // chance the mid moves one tick after each event
+    double meanDepthTicks_ = 20;        // mean distance of a passive order from the mid
+    double burstProbability_ = 0.0005;  // chance per event that a sweep burst starts
+    std::size_t burstLength_ = 20;      // aggressive orders per burst
+    Price sweepTicks_ = 10;             // how far through the mid a sweep is priced
+    Quantity sweepQuantity_ = 2'000;
+    char symbol_[8] = { 'B', 'E', 'N', 'C', 'H', 0, 0, 0 };
+};
+
+// The scenarios CI replays. Sizes keep each replay to a few seconds.
+inline std::vector<WorkloadSpec> BuiltinScenarios()
+{
+    std::vector<WorkloadSpec> scenarios;
+
+    WorkloadSpec balanced;
+    balanced.name_ = "balanced";
+    scenarios.push_back(balanced);
+
+    WorkloadSpec deep = balanced;
+    deep.name_ = "deep-book";
+    deep.preload_ = 500'000;
+    deep.addWeight_ = 0.8;
+    deep.cancelWeight_ = 0.15;
+    deep.modifyWeight_ = 0.05;
+    deep.meanDepthTicks_ = 200;
+    deep.burstProbability_ = 0;
+    scenarios.push_back(deep);
+
+    WorkloadSpec cancels = balanced;
+    cancels.name_ = "cancel-heavy";
+    cancels.addWeight_ = 0.45;
+    cancels.cancelWeight_ = 0.5;
+    cancels.modifyWeight_ = 0.05;
+    cancels.meanDepthTicks_ = 5;
+    scenarios.push_back(cancels);
+
+    WorkloadSpec sweeps = balanced;
+    sweeps.name_ = "sweep-burst";
+    sweeps.preload_ = 200'000;
+    sweeps.burstProbability_ = 0.005;
+    sweeps.sweepTicks_ = 50;
+    sweeps.sweepQuantity_ = 20'000;
+    scenarios.push_back(sweeps);
+
+    return scenarios;
+}
+
+inline std::vector<EngineCommand> GenerateWorkload(const WorkloadSpec& spec)
+{
+    struct LiveOrder
+    {
+        OrderId id_;
+        Side side_;
+    };
+
+    std::mt19937_64 random { spec.seed_ };
+    std::uniform_real_distribution<double> unit { 0.0, 1.0 };
+    std::exponential_distribution<double> arrival { spec.arrivalsPerSecond_ / 1e9 };
+    std::geometric_distribution<Price> depth { 1.0 / (1.0 + spec.meanDepthTicks_) };
+    std::geometric_distribution<Quantity> size { 0.05 };
+
+    std::vector<EngineCommand> commands;
+    commands.reserve(spec.preload_ + spec.commands_);
+    std::vector<LiveOrder> live;
+    live.reserve(spec.preload_ + spec.commands_);
+
+    std::int64_t mid = spec.startMid_;
+    OrderId nextId = 1;
+    double clock = 0;
+    std::size_t burstLeft = 0;
+
+    auto Emit = [&](CommandType type, OrderId id, Side side, std::int64_t price, Quantity quantity)
+    {
+        EngineCommand command {};
+        command.type = type;
+        command.order.type = type == CommandType::CancelOrder ? MessageType::CancelOrder
+                           : type == CommandType::ModifyOrder ? MessageType::ModifyOrder : MessageType::NewOrder;
+        command.order.timestamp = static_cast<std::uint64_t>(clock);
+        command.order.order_id = id;
+        command.order.price = static_cast<std::uint32_t>(std::max<std::int64_t>(1, price));
+        command.order.quantity = quantity;
+        command.order.side = static_cast<std::uint8_t>(side);
+        std::memcpy(command.order.symbol, spec.symbol_, sizeof(spec.symbol_));
+        commands.push_back(command);
+    };
+    // Passive prices never cross the mid, so only sweeps and drift make trades.
+    auto PassivePrice = [&](Side side)
+    {
+        const std::int64_t offset = 1 + static_cast<std::int64_t>(depth(random));
+        return side == Side::Buy ? mid - offset : mid + offset;
+    };
+    auto RandomSide = [&]() { return unit(random) < 0.5 ? Side::Buy : Side::Sell; };
+    auto AddPassive = [&]()
+    {
+        const Side side = RandomSide();
+        Emit(CommandType::NewOrder, nextId, side, PassivePrice(side), 1 + size(random));
+        live.push_back({ nextId++, side });
+    };
+    // Removes a random live order in O(1); it may already have filled, like a real cancel racing a fill.
+    auto TakeLive = [&]()
+    {
+        const std::size_t index = static_cast<std::size_t>(unit(random) * live.size()) % live.size();
+        const LiveOrder order = live[index];
+        live[index] = live.back();
+        live.pop_back();
+        return order;
+    };
+
+    for (std::size_t i = 0; i < spec.preload_; ++i) AddPassive();
+
+    const double total = spec.addWeight_ + spec.cancelWeight_ + spec.modifyWeight_;
+    for (std::size_t i = 0; i < spec.commands_; ++i)
+    {
+        clock += arrival(random);
+        if (burstLeft == 0 && unit(random) < spec.burstProbability_) burstLeft = spec.burstLength_;
+
+        if (burstLeft > 0)
+        {
+            --burstLeft;
+            const Side side = RandomSide();
+            const std::int64_t price = side == Side::Buy ? mid + spec.sweepTicks_ : mid - spec.sweepTicks_;
+            Emit(CommandType::NewOrder, nextId++, side, price, spec.sweepQuantity_);
+        }
+        else
+        {
+            const double pick = unit(random) * total;
+            if (pick < spec.addWeight_ || live.empty()) AddPassive();
+            else if (pick < spec.addWeight_ + spec.cancelWeight_)
+            {
+                const LiveOrder order = TakeLive();
+                Emit(CommandType::CancelOrder, order.id_, order.side_, 0, 0);
+            }
+            else
+            {
+                const LiveOrder order = TakeLive();
+                Emit(CommandType::ModifyOrder, order.id_, order.side_, PassivePrice(order.side_), 1 + size(random));
+                live.push_back(order);
+            }
+        }
+
+        if (unit(random) < spec.driftPerEvent_) mid += unit(random) < 0.5 ? -1 : 1;
+    }
+    return commands;
+}
+
+struct WorkloadHeader
+{
+    char magic_[4] = { 'O', 'B', 'W', 'L' };
+    std::uint32_t version_ = 3; // 2: NewOrderMsg carries an order type; 3: and an expiry
+    std::uint64_t count_ = 0;
+};
+
+inline void SaveWorkload(const std::string& path, const std::vector<EngineCommand>& commands)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error(std::format("Cannot open workload ({}) for writing.", path));
+
+    WorkloadHeader header;
+    header.count_ = commands.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(commands.data()), static_cast<std::streamsize>(commands.size() * sizeof(EngineCommand)));
+    if (!file) throw std::runtime_error(std::format("Failed writing workload ({}).", path));
+}
+
+inline std::vector<EngineCommand> LoadWorkload(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error(std::format("Cannot open workload ({}).", path));
+
+    WorkloadHeader header;
+    const WorkloadHeader expected;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic_, expected.magic_, sizeof(header.magic_)) != 0 || header.version_ != expected.version_)
+        throw std::runtime_error(std::format("Workload ({}) is not a version {} workload file.", path, expected.version_));
+
+    std::vector<EngineCommand> commands(header.count_);
+    file.read(reinterpret_cast<char*>(commands.data()), static_cast<std::streamsize>(commands.size() * sizeof(EngineCommand)));
+    if (!file) throw std::runtime_error(std::format("Workload ({}) is truncated.", path));
+    return commands;
+}
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "Orderbook.h"
+#include "FixedSizePool.h"
+
+// Times the GoodForDay cutover: builds a book of --orders GoodForDay orders
+// (plus --gtc GoodTillCancel ones that must survive), spread over --levels
+// price levels per side, then times the one CancelGoodForDayOrders call the
+// owning thread makes at the close. Nothing else can touch the book meanwhile,
+// so that time is the stall every client sees.
+// Then rests --gtt good-till-time orders with deadlines spread over the next
+// --horizon-ms milliseconds and walks the clock through them a millisecond at
+// a time, the way the engine does, timing each ExpireOrders call.
+// Usage: ./bench_expiry [--orders=N] [--gtc=N] [--gtt=N] [--horizon-ms=N] [--levels=N] [--storage=map|ladder]
+
+using Clock = std::chrono::steady_clock;
+
+struct ExpiryConfig
+{
+    std::size_t orders = 5'000'000;
+    std::size_t gtc = 0;
+    std::size_t gtt = 1'000'000;
+    std::size_t horizonMs = 60'000;
+    std::size_t levels = 1000;
+    LevelStorage storage = LevelStorage::Ladder;
+};
+
+double Milliseconds(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+Order* NewOrder(MemoryPool<Order>& pool, OrderType type, std::size_t i, const ExpiryConfig& config)
+{
+    // Bids at 10000 and below, asks above, so nothing crosses.
+    const Side side = i % 2 == 0 ? Side::Buy : Side::Sell;
+    const auto offset = static_cast<Price>(i / 2 % config.levels);
+    const Price price = side == Side::Buy ? 10000 - offset : 10001 + offset;
+    Order* memory = pool.allocate();
+    if (memory == nullptr) throw std::bad_alloc();
+    return new(memory) Order(type, i + 1, side, price, static_cast<Quantity>(1 + i % 100));
+}
+
+// Order types are interleaved, the way a day's flow mixes them on every level.
+void Fill(OrderBook& book, MemoryPool<Order>& pool, const ExpiryConfig& config)
+{
+    const std::size_t total = config.orders + config.gtc;
+    for (std::size_t i = 0; i < total; ++i)
+    {
+        const OrderType type = i * 2654435761u % total < config.gtc ? OrderType::GoodTillCancel : OrderType::GoodForDay;
+        book.AddOrder(NewOrder(pool, type, i, config), NullTradeSink {});
+    }
+}
+
+// Deadlines are scattered over the horizon rather than rising with the ids.
+void RunGoodTillTime(OrderBook& book, MemoryPool<Order>& pool, const ExpiryConfig& config)
+{
+    using namespace std::chrono;
+    const Timestamp open = sys_days { year { 2026 } / 1 / 2 } + hours { 9 } + minutes { 30 };
+    const std::size_t first = config.orders + config.gtc;
+    // A running engine keeps the book's clock current; one left at the epoch
+    // would put every deadline on one high slot and time moving them all down.
+    book.ExpireOrders(open);
+    for (std::size_t i = 0; i < config.gtt; ++i)
+    {
+        const auto deadline = open + microseconds { 1 + i * 2654435761u % (config.horizonMs * 1000) };
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillTime, first + i, config), NullTradeSink {}, deadline);
+    }
+
+    double total = 0;
+    double worst = 0;
+    for (std::size_t ms = 1; ms <= config.horizonMs; ++ms)
+    {
+        const auto start = Clock::now();
+        book.ExpireOrders(open + milliseconds { ms });
+        const double stall = duration<double, std::micro>(Clock::now() - start).count();
+        total += stall;
+        worst = std::max(worst, stall);
+    }
+    std::cout << "[EXPIRY] Expired " << config.gtt << " good-till-time orders over " << config.horizonMs << " clock advances: "
+              << total / static_cast<double>(config.horizonMs) << " us mean, " << worst << " us worst\n";
+    if (book.Size() != config.gtc) throw std::logic_error("Good-till-time orders outlived their deadlines.");
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        ExpiryConfig config;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option.starts_with("--orders=")) config.orders = std::stoull(option.substr(9));
+            else if (option.starts_with("--gtc=")) config.gtc = std::stoull(option.substr(6));
+            else if (option.starts_with("--gtt=")) config.gtt = std::stoull(option.substr(6));
+            else if (option.starts_with("--horizon-ms=")) config.horizonMs = std::stoull(option.substr(13));
+            else if (option.starts_with("--levels=")) config.levels = std::stoull(option.substr(9));
+            else if (option == "--storage=map") config.storage = LevelStorage::Map;
+            else if (option == "--storage=ladder") config.storage = LevelStorage::Ladder;
+            else {
+                std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+                return 1;
+            }
+        }
+        if (config.levels == 0 || config.horizonMs == 0)
+        {
+            std::cerr << "[ERROR] Need a positive level count and horizon\n";
+            return 1;
+        }
+
+        MemoryPool<Order> pool(config.orders + config.gtc + config.gtt);
+        OrderBook book(pool, true, config.storage, Concurrency::SingleWriter);
+        auto start = Clock::now();
+        Fill(book, pool, config);
+        std::cout << "[EXPIRY] Built a book of " << config.orders << " GoodForDay and " << config.gtc << " GoodTillCancel orders in "
+                  << Milliseconds(start) << " ms\n";
+
+        start = Clock::now();
+        book.CancelGoodForDayOrders();
+        const double stall = Milliseconds(start);
+        std::cout << "[EXPIRY] Close cancelled " << config.orders << " GoodForDay orders in " << stall << " ms ("
+                  << (stall > 0 ? config.orders / (stall / 1000.0) : 0) << " orders/s)\n";
+        if (book.Size() != config.gtc) throw std::logic_error("The close left GoodForDay orders in the book.");
+
+        if (config.gtt != 0) RunGoodTillTime(book, pool, config);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Fatal Exception: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
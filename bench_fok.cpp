@@ -0,0 +1,183 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Orderbook.h"
+#include "FixedSizePool.h"
+#include "CycleClock.h"
+#include "LatencyHistogram.h"
+#include "LatencyReport.h"
+
+// Times FillOrKill orders against a deep book. Each side rests one order on
+// each of --levels consecutive price levels (untimed). Then --ops operations
+// are timed, of which --fok-ratio are FillOrKill orders and the rest passive
+// orders that rest and are cancelled again. Each FillOrKill order names a limit
+// at a random depth and asks for one lot more than the book can hold up to it,
+// a resting passive order included, so it is always killed and the book stays
+// the same: what is timed is the feasibility check, at its worst. The passive
+// operations show what keeping the check cheap costs the orders that rest.
+// Usage: ./bench_fok [--levels=1000,10000,100000] [--ops=20000] [--fok-ratio=0.9] [--storage=map|ladder]
+
+struct FokConfig
+{
+    std::vector<std::size_t> levels { 1000, 10000, 100000 };
+    std::size_t ops = 20000;
+    double fokRatio = 0.9;
+    LevelStorage storage = LevelStorage::Ladder;
+};
+
+struct FokResult
+{
+    LatencyHistogram fok;
+    LatencyHistogram passive;
+    double fokMeanNanos = 0;
+    double passiveMeanNanos = 0;
+};
+
+std::vector<std::size_t> SplitCounts(const std::string& list)
+{
+    std::vector<std::size_t> counts;
+    for (std::size_t start = 0; start <= list.size(); ) {
+        std::size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        if (comma > start) counts.push_back(std::stoul(list.substr(start, comma - start)));
+        start = comma + 1;
+    }
+    return counts;
+}
+
+Order* NewOrder(MemoryPool<Order>& pool, OrderType type, OrderId id, Side side, Price price, Quantity quantity)
+{
+    Order* memory = pool.allocate();
+    if (memory == nullptr) throw std::bad_alloc();
+    return new(memory) Order(type, id, side, price, quantity);
+}
+
+FokResult RunFok(const FokConfig& config, std::size_t levels)
+{
+    constexpr Price BestBid = 100000;
+    constexpr Price BestAsk = BestBid + 1;
+    constexpr Quantity LevelQuantity = 10;
+
+    // The order index is sized from the pool. Room for every id the run hands
+    // out keeps new ids from wrapping onto the resting ones' slots, which
+    // would time probe runs rather than the check.
+    MemoryPool<Order> pool(levels * 2 + config.ops + 16);
+    OrderBook book(pool, true, config.storage, Concurrency::SingleWriter);
+    OrderId nextId = 1;
+    for (std::size_t level = 0; level < levels; ++level)
+    {
+        const auto offset = static_cast<Price>(level);
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, nextId++, Side::Buy, BestBid - offset, LevelQuantity), NullTradeSink {});
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, nextId++, Side::Sell, BestAsk + offset, LevelQuantity), NullTradeSink {});
+    }
+    const std::size_t resting = book.Size();
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<std::size_t> depth(0, levels - 1);
+    std::bernoulli_distribution isFok(config.fokRatio);
+    FokResult result;
+    std::uint64_t fokTicks = 0;
+    std::uint64_t passiveTicks = 0;
+    OrderId passiveId = 0;
+    for (std::size_t op = 0; op < config.ops; ++op)
+    {
+        const std::size_t levelsDeep = depth(rng);
+        const Side side = op % 2 == 0 ? Side::Buy : Side::Sell;
+        const auto offset = static_cast<Price>(levelsDeep);
+        if (isFok(rng))
+        {
+            const Price limit = side == Side::Buy ? BestAsk + offset : BestBid - offset;
+            const auto quantity = static_cast<Quantity>((levelsDeep + 2) * LevelQuantity + 1);
+            Order* order = NewOrder(pool, OrderType::FillOrKill, nextId++, side, limit, quantity);
+            const std::uint64_t start = CycleClock::Now();
+            book.AddOrder(order, NullTradeSink {});
+            const std::uint64_t ticks = CycleClock::Now() - start;
+            result.fok.Record(ticks);
+            fokTicks += ticks;
+        }
+        else
+        {
+            // Rest one order behind the spread on its own side, or cancel the one resting.
+            const std::uint64_t start = CycleClock::Now();
+            if (passiveId == 0)
+            {
+                passiveId = nextId++;
+                const Price price = side == Side::Buy ? BestBid - offset : BestAsk + offset;
+                book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, passiveId, side, price, LevelQuantity), NullTradeSink {});
+            }
+            else
+            {
+                book.CancelOrder(passiveId);
+                passiveId = 0;
+            }
+            const std::uint64_t ticks = CycleClock::Now() - start;
+            result.passive.Record(ticks);
+            passiveTicks += ticks;
+        }
+    }
+    if (book.Size() != resting + (passiveId != 0 ? 1 : 0)) throw std::logic_error("A FillOrKill order traded against the book.");
+
+    if (result.fok.Count() != 0) result.fokMeanNanos = CycleClock::ToNanos(fokTicks) / static_cast<double>(result.fok.Count());
+    if (result.passive.Count() != 0) result.passiveMeanNanos = CycleClock::ToNanos(passiveTicks) / static_cast<double>(result.passive.Count());
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        FokConfig config;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option.starts_with("--levels=")) config.levels = SplitCounts(option.substr(9));
+            else if (option.starts_with("--ops=")) config.ops = std::stoul(option.substr(6));
+            else if (option.starts_with("--fok-ratio=")) config.fokRatio = std::stod(option.substr(12));
+            else if (option == "--storage=map") config.storage = LevelStorage::Map;
+            else if (option == "--storage=ladder") config.storage = LevelStorage::Ladder;
+            else {
+                std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+                return 1;
+            }
+        }
+        if (config.levels.empty() || std::find(config.levels.begin(), config.levels.end(), 0) != config.levels.end() ||
+            config.ops == 0 || config.fokRatio < 0 || config.fokRatio > 1)
+        {
+            std::cerr << "[ERROR] Need positive level counts and ops, and a FillOrKill ratio between 0 and 1\n";
+            return 1;
+        }
+
+        CycleClock::NanosPerTick();
+        std::cout << "[FOK] " << config.ops << " ops, " << config.fokRatio * 100 << "% FillOrKill, "
+                  << (config.storage == LevelStorage::Ladder ? "ladder" : "map") << " levels\n";
+        std::cout << "[FOK]   levels   mean ns/FOK   mean ns/passive\n";
+        std::vector<FokResult> results;
+        for (std::size_t levels : config.levels)
+        {
+            results.push_back(RunFok(config, levels));
+            const FokResult& result = results.back();
+            std::cout << "[FOK] " << std::setw(8) << levels << std::setw(14) << static_cast<std::uint64_t>(result.fokMeanNanos)
+                      << std::setw(18) << static_cast<std::uint64_t>(result.passiveMeanNanos) << "\n";
+        }
+        std::cout << "LATENCY (ns):\n";
+        PrintLatencyHeader(std::cout);
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const std::string fok = "  FOK " + std::to_string(config.levels[i]);
+            const std::string passive = "  rest " + std::to_string(config.levels[i]);
+            PrintLatencyRow(std::cout, fok.c_str(), results[i].fok);
+            PrintLatencyRow(std::cout, passive.c_str(), results[i].passive);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Fatal Exception: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "FlatHashMap.h"
+#include "Order.h"
+#include "Usings.h"
+
+// Microbenchmark for the order-id index: FlatHashMap against the
+// std::unordered_map the book used before, at 1M and 10M live orders.
+// Usage: ./bench_index
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    double insertNs;
+    double lookupNs;
+    double churnNs;
+    double eraseNs;
+};
+
+template <typename Map>
+Result Run(std::size_t live)
+{
+    Map map;
+    map.reserve(live);
+    std::vector<OrderId> probes(live);
+    std::mt19937_64 random(7);
+    for (auto& probe : probes) probe = random() % live;
+
+    auto Elapsed = [](Clock::time_point start, std::size_t ops)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+    };
+
+    Result result;
+    auto start = Clock::now();
+    for (OrderId id = 0; id < live; ++id) map.insert({ id, reinterpret_cast<OrderPointer>(id + 1) });
+    result.insertNs = Elapsed(start, live);
+
+    std::uintptr_t checksum = 0;
+    start = Clock::now();
+    for (OrderId id : probes) checksum += reinterpret_cast<std::uintptr_t>(map.at(id));
+    result.lookupNs = Elapsed(start, live);
+
+    // Steady state: the oldest order leaves as a new one arrives.
+    start = Clock::now();
+    for (OrderId id = 0; id < live; ++id)
+    {
+        map.erase(id);
+        map.insert({ id + live, reinterpret_cast<OrderPointer>(id + 1) });
+    }
+    result.churnNs = Elapsed(start, live);
+
+    start = Clock::now();
+    for (OrderId id = live; id < 2 * live; ++id) map.erase(id);
+    result.eraseNs = Elapsed(start, live);
+
+    if (checksum == 0 || !map.empty()) std::cerr << "[BENCHMARK] unexpected state\n";
+    return result;
+}
+
+void Print(const std::string& name, std::size_t live, const Result& result)
+{
+    std::cout << std::left << std::setw(20) << name
+              << std::right << std::setw(12) << live
+              << std::fixed << std::setprecision(1)
+              << std::setw(12) << result.insertNs
+              << std::setw(12) << result.lookupNs
+              << std::setw(14) << result.churnNs
+              << std::setw(12) << result.eraseNs << "\n";
+}
+
+int main()
+{
+    std::cout << std::left << std::setw(20) << "map"
+              << std::right << std::setw(12) << "live"
+              << std::setw(12) << "insert ns"
+              << std::setw(12) << "lookup ns"
+              << std::setw(14) << "erase+ins ns"
+              << std::setw(12) << "erase ns" << "\n";
+
+    for (std::size_t live : { std::size_t{1000000}, std::size_t{10000000} })
+    {
+        Print("std::unordered_map", live, Run<std::unordered_map<OrderId, OrderPointer>>(live));
+        Print("FlatHashMap", live, Run<FlatHashMap<OrderId, OrderPointer>>(live));
+    }
+    return 0;
+}
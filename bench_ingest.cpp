@@ -0,0 +1,263 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+#include "NetworkIngest.h"
+#include "Protocol.h"
+
+// Loopback benchmark for the two network ingest back ends in NetworkIngest.h,
+// without an engine behind them: every decoded frame only bumps a counter.
+// Each pass starts a fresh server on an ephemeral port, streams --total frames
+// split over the connections in 64 KB writes, and times until the server has
+// read every frame and closed the sockets. Syscalls are the back end's own
+// count (see NetworkIngest.h); for Asio it is a floor.
+// Usage: ./bench_ingest [--connections=1,10,100] [--total=N] [--io-threads=1] [--backend=asio|uring|both]
+
+using Clock = std::chrono::steady_clock;
+
+struct IngestConfig
+{
+    std::vector<std::size_t> connections { 1, 10, 100 };
+    std::uint64_t total = 8'000'000;
+    std::size_t ioThreads = 1;
+    bool asio = true;
+    bool uring = true;
+};
+
+struct PassResult
+{
+    double messagesPerSecond = 0;
+    double syscallsPerSecond = 0;
+    double messagesPerSyscall = 0;
+};
+
+// Counts frames, publishing the count once per batch like the engine's FrameRouter.
+class CountingRouter
+{
+    public:
+        explicit CountingRouter(std::atomic<std::uint64_t>& received): received_ { &received } {}
+
+        template <typename Message>
+        void operator()(const Message&) { ++pending_; }
+
+        void Flush()
+        {
+            received_->fetch_add(pending_, std::memory_order_relaxed);
+            pending_ = 0;
+        }
+
+    private:
+        std::atomic<std::uint64_t>* received_;
+        std::uint64_t pending_ = 0;
+};
+
+std::vector<std::string> SplitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    for (std::size_t start = 0; start <= list.size(); ) {
+        std::size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        if (comma > start) items.push_back(list.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return items;
+}
+
+void RunClient(unsigned short port, std::uint64_t messages, std::size_t connection)
+{
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::socket socket(io);
+    socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+    socket.set_option(boost::asio::ip::tcp::no_delay(true));
+
+    constexpr std::size_t FramesPerWrite = 65536 / sizeof(NewOrderMsg);
+    std::vector<char> buffer(FramesPerWrite * sizeof(NewOrderMsg));
+    std::uint64_t nextId = (static_cast<std::uint64_t>(connection) + 1) << 40;
+    while (messages > 0)
+    {
+        const std::size_t frames = static_cast<std::size_t>(std::min<std::uint64_t>(messages, FramesPerWrite));
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            NewOrderMsg msg {};
+            msg.type = MessageType::NewOrder;
+            msg.order_id = nextId++;
+            msg.price = 15000;
+            msg.quantity = 10;
+            std::memcpy(msg.symbol, "AAPL", 4);
+            std::memcpy(buffer.data() + i * sizeof(msg), &msg, sizeof(msg));
+        }
+        boost::asio::write(socket, boost::asio::buffer(buffer.data(), frames * sizeof(NewOrderMsg)));
+        messages -= frames;
+    }
+    // The server closes once it has read everything, which ends the timed pass.
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_send);
+    char ignored;
+    boost::system::error_code closed;
+    socket.read_some(boost::asio::buffer(&ignored, 1), closed);
+}
+
+void RunClients(unsigned short port, std::size_t connections, std::uint64_t total)
+{
+    const std::uint64_t messages = std::max<std::uint64_t>(1, total / connections);
+    std::vector<std::thread> clients;
+    for (std::size_t i = 0; i < connections; ++i)
+    {
+        clients.emplace_back([port, messages, i]()
+        {
+            try { RunClient(port, messages, i); }
+            catch (const std::exception& e) { std::cerr << "[INGEST] Client " << i << " failed: " << e.what() << "\n"; }
+        });
+    }
+    for (auto& client : clients) client.join();
+}
+
+PassResult Summarize(const char* backend, std::size_t connections, std::uint64_t received, std::uint64_t syscalls, double seconds)
+{
+    PassResult result { received / seconds, syscalls / seconds, syscalls > 0 ? static_cast<double>(received) / syscalls : 0.0 };
+    std::cout << "[INGEST] " << backend << " x " << connections << " connections: " << received << " frames in " << seconds
+              << " s, " << syscalls << " syscalls\n";
+    return result;
+}
+
+PassResult RunAsioPass(const IngestConfig& config, std::size_t connections)
+{
+    std::atomic<std::uint64_t> received { 0 };
+    std::vector<std::unique_ptr<AsioIngestThread<CountingRouter>>> threads;
+    for (std::size_t i = 0; i < config.ioThreads; ++i)
+    {
+        threads.push_back(std::make_unique<AsioIngestThread<CountingRouter>>(CountingRouter { received }));
+        threads.back()->Start();
+    }
+
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::acceptor acceptor(io, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    const unsigned short port = acceptor.local_endpoint().port();
+    std::thread acceptThread([&]()
+    {
+        for (std::size_t i = 0; i < connections; ++i)
+        {
+            auto& thread = *threads[i % threads.size()];
+            thread.Serve(acceptor.accept(thread.Context()));
+        }
+    });
+
+    const auto start = Clock::now();
+    RunClients(port, connections, config.total);
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    acceptThread.join();
+
+    std::uint64_t syscalls = 0;
+    for (auto& thread : threads)
+    {
+        thread->Stop();
+        syscalls += thread->Syscalls();
+    }
+    return Summarize("asio ", connections, received.load(), syscalls, elapsed.count());
+}
+
+PassResult RunUringPass(const IngestConfig& config, std::size_t connections)
+{
+    std::atomic<std::uint64_t> received { 0 };
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::acceptor acceptor(io, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    const unsigned short port = acceptor.local_endpoint().port();
+
+    std::vector<std::unique_ptr<UringIngestThread<CountingRouter>>> threads;
+    for (std::size_t i = 0; i < config.ioThreads; ++i)
+        threads.push_back(std::make_unique<UringIngestThread<CountingRouter>>(CountingRouter { received }, acceptor.native_handle()));
+    // Count only the serving loop, not the set-up probe.
+    std::uint64_t probeSyscalls = 0;
+    for (auto& thread : threads)
+    {
+        probeSyscalls += thread->Syscalls();
+        thread->Start();
+    }
+
+    const auto start = Clock::now();
+    RunClients(port, connections, config.total);
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    std::uint64_t syscalls = 0;
+    for (auto& thread : threads)
+    {
+        thread->Stop();
+        syscalls += thread->Syscalls();
+    }
+    return Summarize("uring", connections, received.load(), syscalls - probeSyscalls, elapsed.count());
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        IngestConfig config;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option.starts_with("--connections=")) {
+                config.connections.clear();
+                for (const auto& count : SplitList(option.substr(14))) config.connections.push_back(std::stoul(count));
+            }
+            else if (option.starts_with("--total=")) config.total = std::stoull(option.substr(8));
+            else if (option.starts_with("--io-threads=")) config.ioThreads = std::stoul(option.substr(13));
+            else if (option == "--backend=asio") config.uring = false;
+            else if (option == "--backend=uring") config.asio = false;
+            else if (option == "--backend=both") config.asio = config.uring = true;
+            else {
+                std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+                return 1;
+            }
+        }
+        const bool noConnections = config.connections.empty() ||
+            std::find(config.connections.begin(), config.connections.end(), 0) != config.connections.end();
+        if (noConnections || config.ioThreads == 0 || config.total == 0)
+        {
+            std::cerr << "[ERROR] Need positive connection counts, I/O threads and total\n";
+            return 1;
+        }
+
+        std::vector<PassResult> asio;
+        std::vector<PassResult> uring;
+        for (std::size_t connections : config.connections)
+        {
+            if (config.asio) asio.push_back(RunAsioPass(config, connections));
+            if (config.uring)
+            {
+                try { uring.push_back(RunUringPass(config, connections)); }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "[INGEST] io_uring unavailable, skipping it: " << e.what() << "\n";
+                    config.uring = false;
+                }
+            }
+        }
+
+        std::cout << "\n[INGEST] connections  backend        msg/s   syscalls/s   msgs/syscall\n";
+        for (std::size_t i = 0; i < config.connections.size(); ++i)
+        {
+            auto row = [&](const char* backend, const PassResult& result)
+            {
+                std::cout << "[INGEST] " << std::setw(11) << config.connections[i] << "  " << backend
+                          << std::setw(13) << static_cast<std::uint64_t>(result.messagesPerSecond)
+                          << std::setw(13) << static_cast<std::uint64_t>(result.syscallsPerSecond)
+                          << std::setw(15) << std::fixed << std::setprecision(1) << result.messagesPerSyscall << "\n";
+            };
+            if (i < asio.size()) row("asio ", asio[i]);
+            if (i < uring.size()) row("uring", uring[i]);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Fatal Exception: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
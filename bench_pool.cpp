@@ -0,0 +1,78 @@
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FixedSizePool.h"
+#include "Order.h"
+
+// Multi-threaded alloc/free stress for MemoryPool: the shared CAS free list
+// against the per-thread magazines, from 1 to 16 threads. Every thread
+// allocates a burst of orders and frees them again, like a client thread
+// in sync mode.
+// Usage: ./bench_pool [--ops=N]   (alloc/free pairs per thread)
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t Burst = 16;
+
+double Run(std::size_t threads, std::size_t ops, bool threadCache)
+{
+    MemoryPool<Order> pool(threads * Burst * 8, PoolOptions { .thread_cache = threadCache });
+    std::atomic<std::size_t> ready { 0 };
+    std::atomic<bool> go { false };
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&]
+        {
+            Order* held[Burst];
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (std::size_t done = 0; done < ops; done += Burst)
+            {
+                for (auto& block : held) block = pool.allocate();
+                for (auto* block : held) pool.deallocate(block);
+            }
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) worker.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    return threads * ops / elapsed.count() / 1e6;
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t ops = 4'000'000;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string option = argv[i];
+        if (option.starts_with("--ops=")) ops = std::stoull(option.substr(6));
+        else {
+            std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+            return 1;
+        }
+    }
+
+    std::cout << std::right << std::setw(8) << "threads"
+              << std::setw(16) << "shared Mops/s"
+              << std::setw(18) << "magazine Mops/s"
+              << std::setw(10) << "speedup" << "\n";
+    for (std::size_t threads : { 1, 2, 4, 8, 16 })
+    {
+        const double shared = Run(threads, ops, false);
+        const double cached = Run(threads, ops, true);
+        std::cout << std::setw(8) << threads
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(16) << shared
+                  << std::setw(18) << cached
+                  << std::setw(9) << cached / shared << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Workload.h"
+#include "Orderbook.h"
+#include "FixedSizePool.h"
+#include "LatencyReport.h"
+
+// Replays workload files (see workload_gen) through a single-writer book and
+// reports throughput and per-operation latency for each. Thresholds turn it
+// into a regression gate: the exit code is 1 if any scenario misses them.
+// Usage: ./bench_replay <file.wl>... [--levels=map|ladder] [--max-p99=NS] [--min-ops=N]
+
+struct ReplayResult
+{
+    double opsPerSecond;
+    LatencyHistogram add;
+    LatencyHistogram cancel;
+    LatencyHistogram modify;
+};
+
+Order* NewOrder(MemoryPool<Order>& pool, const NewOrderMsg& msg)
+{
+    Order* memory = pool.allocate();
+    if (memory == nullptr) throw std::bad_alloc();
+    return new(memory) Order(OrderType::GoodTillCancel, msg.order_id, static_cast<Side>(msg.side),
+        static_cast<Price>(msg.price), static_cast<Quantity>(msg.quantity));
+}
+
+ReplayResult Replay(const std::vector<EngineCommand>& commands, LevelStorage levels)
+{
+    // Every add and every modify may take a fresh order from the pool.
+    std::size_t capacity = 1;
+    for (const auto& command : commands) capacity += command.type != CommandType::CancelOrder;
+    MemoryPool<Order> pool(capacity);
+    OrderBook book(pool, true, levels, Concurrency::SingleWriter);
+
+    ReplayResult result {};
+    std::size_t trades = 0;
+    auto countTrade = [&trades](const Trade&) { ++trades; };
+    const TradeCallback sink { countTrade };
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& command : commands)
+    {
+        const NewOrderMsg& msg = command.order;
+        const std::uint64_t begin = CycleClock::Now();
+        switch (command.type)
+        {
+            case CommandType::NewOrder:
+                book.AddOrder(NewOrder(pool, msg), sink, Timestamp { std::chrono::nanoseconds { msg.expiry } });
+                result.add.Record(CycleClock::Now() - begin);
+                break;
+            case CommandType::CancelOrder:
+                book.CancelOrder(msg.order_id);
+                result.cancel.Record(CycleClock::Now() - begin);
+                break;
+            case CommandType::ModifyOrder:
+                book.ModifyOrder(OrderModify { msg.order_id, static_cast<Side>(msg.side),
+                    static_cast<Price>(msg.price), static_cast<Quantity>(msg.quantity) }, sink);
+                result.modify.Record(CycleClock::Now() - begin);
+                break;
+            case CommandType::ExpireGoodForDay:
+                book.CancelGoodForDayOrders();
+                break;
+            case CommandType::ExpireOrders:
+                book.ExpireOrders(Timestamp { std::chrono::nanoseconds { msg.expiry } });
+                break;
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    result.opsPerSecond = commands.size() / elapsed.count();
+    std::cout << "Replayed " << commands.size() << " commands in " << elapsed.count() * 1000.0 << " ms: "
+              << trades << " trades, " << book.Size() << " resting\n";
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        std::vector<std::string> files;
+        LevelStorage levels = LevelStorage::Map;
+        std::uint64_t maxP99 = 0;
+        double minOps = 0;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option == "--levels=map") levels = LevelStorage::Map;
+            else if (option == "--levels=ladder") levels = LevelStorage::Ladder;
+            else if (option.starts_with("--max-p99=")) maxP99 = std::stoull(option.substr(10));
+            else if (option.starts_with("--min-ops=")) minOps = std::stod(option.substr(10));
+            else if (option.starts_with("--")) {
+                std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+                return 1;
+            }
+            else files.push_back(option);
+        }
+        if (files.empty())
+        {
+            std::cerr << "Usage: ./bench_replay <file.wl>... [--levels=map|ladder] [--max-p99=NS] [--min-ops=N]\n";
+            return 1;
+        }
+
+        // Calibrate before the first timed replay rather than inside it.
+        CycleClock::NanosPerTick();
+
+        bool passed = true;
+        for (const auto& file : files)
+        {
+            const std::vector<EngineCommand> commands = LoadWorkload(file);
+            std::cout << "\n========================================\n";
+            std::cout << "SCENARIO: " << file << " | Levels: " << (levels == LevelStorage::Ladder ? "LADDER" : "MAP") << "\n";
+            const ReplayResult result = Replay(commands, levels);
+            std::cout << "THROUGHPUT: " << result.opsPerSecond << " Ops/Sec\n";
+            std::cout << "LATENCY (ns):\n";
+            PrintLatencyHeader(std::cout);
+            PrintLatencyRow(std::cout, "  add", result.add);
+            PrintLatencyRow(std::cout, "  cancel", result.cancel);
+            PrintLatencyRow(std::cout, "  modify", result.modify);
+
+            if (minOps > 0 && result.opsPerSecond < minOps)
+            {
+                std::cout << "[FAIL] throughput below " << minOps << " Ops/Sec\n";
+                passed = false;
+            }
+            for (const auto* histogram : { &result.add, &result.cancel, &result.modify })
+            {
+                const std::uint64_t p99 = CycleClock::ToNanos(histogram->Percentile(99));
+                if (maxP99 > 0 && histogram->Count() > 0 && p99 > maxP99)
+                {
+                    std::cout << "[FAIL] p99 " << p99 << " ns above " << maxP99 << " ns\n";
+                    passed = false;
+                }
+            }
+            std::cout << "========================================\n";
+        }
+        return passed ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Fatal Exception: " << e.what() << "\n";
+        return 1;
+    }
+}
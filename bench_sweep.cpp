@@ -0,0 +1,150 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Orderbook.h"
+#include "FixedSizePool.h"
+#include "CycleClock.h"
+#include "LatencyHistogram.h"
+#include "LatencyReport.h"
+
+// Times one aggressive order sweeping a whole side of the book. Each round
+// rests --per-level sell orders on each of --levels price levels (untimed),
+// then times a single buy for their total quantity, which takes every level.
+// By default the buy is a limit order priced at the last level; --market sends
+// a Market order instead. Executions go to a counting listener.
+// Usage: ./bench_sweep [--levels=10,100,1000] [--per-level=10] [--rounds=500] [--storage=map|ladder] [--market]
+
+struct SweepConfig
+{
+    std::vector<std::size_t> levels { 10, 100, 1000 };
+    std::size_t perLevel = 10;
+    std::size_t rounds = 500;
+    LevelStorage storage = LevelStorage::Ladder;
+    bool market = false;
+};
+
+struct SweepResult
+{
+    LatencyHistogram sweep;
+    double meanNanos = 0;
+    std::uint64_t fills = 0;
+};
+
+std::vector<std::size_t> SplitCounts(const std::string& list)
+{
+    std::vector<std::size_t> counts;
+    for (std::size_t start = 0; start <= list.size(); ) {
+        std::size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        if (comma > start) counts.push_back(std::stoul(list.substr(start, comma - start)));
+        start = comma + 1;
+    }
+    return counts;
+}
+
+Order* NewOrder(MemoryPool<Order>& pool, OrderType type, OrderId id, Side side, Price price, Quantity quantity)
+{
+    Order* memory = pool.allocate();
+    if (memory == nullptr) throw std::bad_alloc();
+    return new(memory) Order(type, id, side, price, quantity);
+}
+
+SweepResult RunSweeps(const SweepConfig& config, std::size_t levels)
+{
+    MemoryPool<Order> pool(levels * config.perLevel + 16);
+    OrderBook book(pool, true, config.storage, Concurrency::SingleWriter);
+    SweepResult result;
+    std::uint64_t fills = 0;
+    auto countFill = [&fills](const Trade&) { ++fills; };
+    const TradeCallback sink { countFill };
+
+    constexpr Price FirstAsk = 10000;
+    OrderId nextId = 1;
+    std::uint64_t totalTicks = 0;
+    for (std::size_t round = 0; round < config.rounds; ++round)
+    {
+        Quantity total = 0;
+        for (std::size_t level = 0; level < levels; ++level)
+        {
+            for (std::size_t i = 0; i < config.perLevel; ++i)
+            {
+                const auto quantity = static_cast<Quantity>(1 + (nextId % 7));
+                book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, nextId++, Side::Sell, FirstAsk + static_cast<Price>(level), quantity), sink);
+                total += quantity;
+            }
+        }
+
+        Order* sweep = config.market
+            ? NewOrder(pool, OrderType::Market, nextId++, Side::Buy, Constants::InvalidPrice, total)
+            : NewOrder(pool, OrderType::GoodTillCancel, nextId++, Side::Buy, FirstAsk + static_cast<Price>(levels - 1), total);
+        fills = 0;
+        const std::uint64_t start = CycleClock::Now();
+        book.AddOrder(sweep, sink);
+        const std::uint64_t ticks = CycleClock::Now() - start;
+        result.sweep.Record(ticks);
+        totalTicks += ticks;
+        result.fills = fills;
+        if (book.Size() != 0) throw std::logic_error("The sweep left orders in the book.");
+    }
+    result.meanNanos = CycleClock::ToNanos(totalTicks) / static_cast<double>(config.rounds);
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        SweepConfig config;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option.starts_with("--levels=")) config.levels = SplitCounts(option.substr(9));
+            else if (option.starts_with("--per-level=")) config.perLevel = std::stoul(option.substr(12));
+            else if (option.starts_with("--rounds=")) config.rounds = std::stoul(option.substr(9));
+            else if (option == "--storage=map") config.storage = LevelStorage::Map;
+            else if (option == "--storage=ladder") config.storage = LevelStorage::Ladder;
+            else if (option == "--market") config.market = true;
+            else {
+                std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+                return 1;
+            }
+        }
+        if (config.levels.empty() || config.perLevel == 0 || config.rounds == 0)
+        {
+            std::cerr << "[ERROR] Need positive level counts, orders per level and rounds\n";
+            return 1;
+        }
+
+        CycleClock::NanosPerTick();
+        std::cout << "[SWEEP] " << (config.market ? "Market" : "Limit") << " sweeps, " << config.perLevel << " orders per level, "
+                  << config.rounds << " rounds, " << (config.storage == LevelStorage::Ladder ? "ladder" : "map") << " levels\n";
+        std::cout << "[SWEEP]   levels    fills   mean ns/sweep   ns/fill\n";
+        std::vector<SweepResult> results;
+        for (std::size_t levels : config.levels)
+        {
+            results.push_back(RunSweeps(config, levels));
+            const SweepResult& result = results.back();
+            std::cout << "[SWEEP] " << std::setw(8) << levels << std::setw(9) << result.fills
+                      << std::setw(16) << static_cast<std::uint64_t>(result.meanNanos)
+                      << std::setw(10) << std::fixed << std::setprecision(1) << result.meanNanos / std::max<std::uint64_t>(1, result.fills) << "\n";
+        }
+        std::cout << "LATENCY (ns):\n";
+        PrintLatencyHeader(std::cout);
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const std::string name = "  " + std::to_string(config.levels[i]) + " levels";
+            PrintLatencyRow(std::cout, name.c_str(), results[i].sweep);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Fatal Exception: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,9 +1,8 @@
 import streamlit as st
 import pandas as pd
-import json
-import os
 import time
 import subprocess
+from feed_reader import FeedReader
 
 st.set_page_config(page_title="C++ Matching Engine Profiler", layout="wide")
 st.sidebar.header("🕹️ Simulation Control")
@@ -33,17 +32,18 @@ st.markdown("Live Performance Profiler & Depth of Market")
 if "ops_history" not in st.session_state:
     st.session_state.ops_history = [0] * 60 
 
-def safe_read_json(filepath):
-    if os.path.exists(filepath):
-        try:
-            with open(filepath, "r") as f:
-                return json.load(f)
-        except:
-            return None
-    return None
+def open_feed():
+    # The engine creates the feed when it starts and removes it when it exits.
+    try:
+        return FeedReader()
+    except (OSError, ValueError):
+        return None
 
 if not freeze:
-    metrics = safe_read_json("metrics.json")
+    feed = open_feed()
+    if feed is None:
+        st.info("Waiting for the engine's market data feed (/dev/shm/orderbook_feed)...")
+    metrics = feed.read_counters() if feed else None
     if metrics:
         network_ops = metrics.get("network_ops", 0)
         engine_ops = metrics.get("engine_ops", 0)
@@ -67,7 +67,8 @@ if not freeze:
     st.markdown("---")
     st.subheader("📊 Depth of Market (DOM)")
     
-    book_data = safe_read_json("book_state.json")
+    book_data = feed.read_book() if feed else None
+    if feed: feed.close()
     if book_data:
         bids = pd.DataFrame(book_data.get("bids", []))
         asks = pd.DataFrame(book_data.get("asks", []))
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <chrono>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "MarketDataFeed.h"
+
+// Attaches to the engine's shared-memory market data feed and prints the
+// counters and the top of the book it follows. Reading never blocks the engine.
+// Usage: ./feed_reader [--name=/orderbook_feed] [--levels=10] [--follow]
+
+std::string_view SymbolName(const char (&symbol)[8])
+{
+    std::string_view name { symbol, sizeof(symbol) };
+    return name.substr(0, name.find('\0'));
+}
+
+void PrintFeed(const MarketDataFeedReader& reader, std::size_t levels)
+{
+    const FeedCounters counters = reader.ReadCounters();
+    const BookView book = reader.ReadBook();
+
+    std::cout << "[FEED] update " << counters.updates_ << " | network " << counters.networkOps_ << " ops/s ("
+              << counters.totalNetwork_ << " total) | engine " << counters.engineOps_ << " ops/s ("
+              << counters.totalEngine_ << " total) | unknown symbol " << counters.unknownSymbol_ << "\n";
+    for (std::uint32_t i = 0; i < counters.symbolCount_ && i < FeedCounters::MaxSymbols; ++i)
+    {
+        const FeedSymbol& symbol = counters.symbols_[i];
+        std::cout << "  " << std::left << std::setw(8) << SymbolName(symbol.symbol_) << std::right
+                  << symbol.engineOps_ << " ops/s, " << symbol.totalEngine_ << " total | pool: " << symbol.poolLive_ << " live, "
+                  << symbol.poolHighWater_ << " peak, " << symbol.poolChunks_ << " chunks, " << symbol.poolExhausted_ << " exhausted\n";
+    }
+    for (std::uint32_t i = 0; i < counters.shardCount_ && i < FeedCounters::MaxShards; ++i)
+    {
+        const FeedShard& shard = counters.shards_[i];
+        std::cout << "  Shard " << i << " (core " << shard.core_ << "): " << shard.engineOps_ << " ops/s, "
+                  << shard.totalEngine_ << " total\n";
+    }
+
+    std::cout << "  " << SymbolName(reader.Header().bookSymbol_) << ": " << book.orders_ << " resting\n";
+    std::cout << "  " << std::setw(12) << "bid qty" << std::setw(10) << "bid" << std::setw(10) << "ask" << std::setw(12) << "ask qty" << "\n";
+    for (std::size_t i = 0; i < levels && (i < book.bidLevels_ || i < book.askLevels_); ++i)
+    {
+        std::cout << "  ";
+        if (i < book.bidLevels_) std::cout << std::setw(12) << book.bids_[i].quantity_ << std::setw(10) << book.bids_[i].price_;
+        else std::cout << std::setw(22) << "";
+        if (i < book.askLevels_) std::cout << std::setw(10) << book.asks_[i].price_ << std::setw(12) << book.asks_[i].quantity_;
+        std::cout << "\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        std::string name = MarketDataFeed::DefaultName;
+        std::size_t levels = 10;
+        bool follow = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option.starts_with("--name=")) name = option.substr(7);
+            else if (option.starts_with("--levels=")) levels = std::stoul(option.substr(9));
+            else if (option == "--follow") follow = true;
+            else {
+                std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+                return 1;
+            }
+        }
+        if (levels > BookView::Depth) levels = BookView::Depth;
+
+        const MarketDataFeedReader reader(name);
+        do
+        {
+            PrintFeed(reader, levels);
+            if (follow) std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+        while (follow);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Fatal Exception: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+import mmap
+import os
+import struct
+import time
+
+# Python side of the engine's shared-memory market data feed (MarketDataFeed.h).
+# The layouts below mirror the C++ structs for feed version 1; every section is
+# a seqlock whose sequence sits at its start and whose value sits 64 bytes in.
+
+FEED_PATH = "/dev/shm/orderbook_feed"
+FEED_MAGIC = b"OBFEED\0\0"
+FEED_VERSION = 1
+
+HEADER = struct.Struct("<8sIIQQQ8s")
+BOOK_HEAD = struct.Struct("<QII")
+LEVEL = struct.Struct("<iI")
+COUNTERS_HEAD = struct.Struct("<QQQQQQII")
+SYMBOL = struct.Struct("<8sQQQQQQ")
+SHARD = struct.Struct("<QQQ")
+SEQUENCE = struct.Struct("<Q")
+SEQLOCK_VALUE_OFFSET = 64
+MAX_SYMBOLS = 32
+MAX_SHARDS = 64
+
+
+def _name(raw):
+    return raw.split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+class FeedReader:
+    def __init__(self, path=FEED_PATH):
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            self._map = mmap.mmap(fd, 0, mmap.MAP_SHARED, mmap.PROT_READ)
+        finally:
+            os.close(fd)
+        magic, version, self.depth, self._book, self._counters, size, symbol = HEADER.unpack_from(self._map, 0)
+        if magic != FEED_MAGIC or version != FEED_VERSION or size > len(self._map):
+            self._map.close()
+            raise ValueError(f"{path} is not a version {FEED_VERSION} market data feed")
+        self.book_symbol = _name(symbol)
+        self._book_size = BOOK_HEAD.size + 2 * self.depth * LEVEL.size
+        self._counters_size = COUNTERS_HEAD.size + MAX_SYMBOLS * SYMBOL.size + MAX_SHARDS * SHARD.size
+
+    def close(self):
+        self._map.close()
+
+    def _read(self, offset, size):
+        # Copy the value out, then retry if the writer was in it or moved past it.
+        while True:
+            before = SEQUENCE.unpack_from(self._map, offset)[0]
+            if before & 1:
+                time.sleep(0)
+                continue
+            value = self._map[offset + SEQLOCK_VALUE_OFFSET:offset + SEQLOCK_VALUE_OFFSET + size]
+            if SEQUENCE.unpack_from(self._map, offset)[0] == before:
+                return value
+
+    def read_book(self):
+        raw = self._read(self._book, self._book_size)
+        orders, bid_levels, ask_levels = BOOK_HEAD.unpack_from(raw, 0)
+        asks_at = BOOK_HEAD.size + self.depth * LEVEL.size
+
+        def levels(start, count):
+            return [dict(zip(("price", "quantity"), LEVEL.unpack_from(raw, start + i * LEVEL.size))) for i in range(count)]
+
+        return {"orders": orders,
+                "bids": levels(BOOK_HEAD.size, min(bid_levels, self.depth)),
+                "asks": levels(asks_at, min(ask_levels, self.depth))}
+
+    def read_counters(self):
+        raw = self._read(self._counters, self._counters_size)
+        (updates, network_ops, engine_ops, total_network, total_engine,
+         unknown_symbol, symbol_count, shard_count) = COUNTERS_HEAD.unpack_from(raw, 0)
+        symbols = []
+        for i in range(min(symbol_count, MAX_SYMBOLS)):
+            name, ops, total, live, high_water, chunks, exhausted = SYMBOL.unpack_from(raw, COUNTERS_HEAD.size + i * SYMBOL.size)
+            symbols.append({"symbol": _name(name), "engine_ops": ops, "total_engine": total, "pool_live": live,
+                            "pool_high_water": high_water, "pool_chunks": chunks, "pool_exhausted": exhausted})
+        shards = []
+        shards_at = COUNTERS_HEAD.size + MAX_SYMBOLS * SYMBOL.size
+        for i in range(min(shard_count, MAX_SHARDS)):
+            core, ops, total = SHARD.unpack_from(raw, shards_at + i * SHARD.size)
+            shards.append({"core": core, "engine_ops": ops, "total_engine": total})
+        return {"updates": updates, "network_ops": network_ops, "engine_ops": engine_ops,
+                "total_network": total_network, "total_engine": total_engine,
+                "unknown_symbol": unknown_symbol, "symbols": symbols, "shards": shards}
+
+
+if __name__ == "__main__":
+    reader = FeedReader()
+    print(reader.read_counters())
+    book = reader.read_book()
+    print(f"{reader.book_symbol}: {book['orders']} resting, top bid {book['bids'][:1]}, top ask {book['asks'][:1]}")
@@ -6,7 +6,7 @@ import threading
 import sys
 
 def trader_bot(trader_id, num_orders):
-    msg_format = '<BQQIIB8s'
+    msg_format = '<BQQIIB8sBQ'
     symbols = [b'AAPL\x00\x00\x00\x00', b'TSLA\x00\x00\x00\x00', b'MSFT\x00\x00\x00\x00']
     
     try:
@@ -16,7 +16,7 @@ def trader_bot(trader_id, num_orders):
         for i in range(num_orders):
             binary_payload = struct.pack(msg_format, 1, int(time.time_ns()), i, 
                 random.randint(14900, 15100), random.randint(1, 100), 
-                random.choice([0, 1]), random.choice(symbols)
+                random.choice([0, 1]), random.choice(symbols), 0, 0
             )
             s.sendall(binary_payload)
             
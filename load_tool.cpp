@@ -0,0 +1,235 @@
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+#include "Protocol.h"
+#include "OrderType.h"
+
+// Native load generator for the live engine. Every connection streams a mix of
+// New / Cancel / Modify frames in 64 KB writes; cancels and modifies target the
+// connection's recent orders, so most of them hit live orders.
+// A list of connection counts runs one pass per count and prints a scaling
+// table; --total fixes the messages per pass and splits them over the connections.
+// Usage: ./load_tool [--host=127.0.0.1] [--port=8080] [--connections=4|1,10,100,1000] [--messages=N | --total=N]
+//                    [--cancel=0.4] [--modify=0.1] [--symbols=AAPL,TSLA,MSFT]
+
+struct LoadConfig
+{
+    std::string host = "127.0.0.1";
+    std::string port = "8080";
+    std::vector<std::size_t> connections { 4 };
+    std::uint64_t messages = 5'000'000; // per connection
+    std::uint64_t total = 0;            // per pass, split over the connections; 0 uses `messages`
+    double cancelRatio = 0.4;
+    double modifyRatio = 0.1;
+    std::vector<std::string> symbols { "AAPL", "TSLA", "MSFT" };
+};
+
+// xorshift64*: a few cycles per draw, so generation never limits the socket.
+class FastRandom
+{
+    public:
+        explicit FastRandom(std::uint64_t seed): state_ { seed | 1 } {}
+
+        std::uint64_t Next()
+        {
+            state_ ^= state_ >> 12;
+            state_ ^= state_ << 25;
+            state_ ^= state_ >> 27;
+            return state_ * 0x2545F4914F6CDD1Dull;
+        }
+        double Unit() { return (Next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    private:
+        std::uint64_t state_;
+};
+
+std::vector<std::string> SplitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    for (std::size_t start = 0; start <= list.size(); ) {
+        std::size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        if (comma > start) items.push_back(list.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return items;
+}
+
+void RunConnection(const LoadConfig& config, std::uint64_t messages, std::size_t connection, std::atomic<std::uint64_t>& sent)
+{
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::socket socket(io);
+    boost::asio::connect(socket, boost::asio::ip::tcp::resolver(io).resolve(config.host, config.port));
+    socket.set_option(boost::asio::ip::tcp::no_delay(true));
+
+    std::vector<std::array<char, 8>> symbols;
+    for (const auto& name : config.symbols)
+    {
+        std::array<char, 8> symbol {};
+        std::memcpy(symbol.data(), name.data(), std::min<std::size_t>(name.size(), symbol.size()));
+        symbols.push_back(symbol);
+    }
+
+    constexpr std::size_t RecentMask = 4095;
+    std::vector<std::uint64_t> recent(RecentMask + 1);
+    std::vector<std::uint8_t> recentSymbol(RecentMask + 1);
+    FastRandom random { 0x9E3779B97F4A7C15ull * (connection + 1) };
+    // Ids are unique across connections: the connection number sits in the top bits.
+    std::uint64_t nextId = (static_cast<std::uint64_t>(connection) + 1) << 40;
+    std::uint64_t added = 0;
+
+    std::vector<char> buffer(64 * 1024);
+    std::uint64_t remaining = messages;
+    while (remaining > 0)
+    {
+        std::size_t used = 0;
+        while (remaining > 0 && buffer.size() - used >= sizeof(NewOrderMsg))
+        {
+            char* frame = buffer.data() + used;
+            const double pick = random.Unit();
+            const std::size_t slot = random.Next() & RecentMask;
+            const bool haveTarget = added > RecentMask;
+
+            if (haveTarget && pick < config.cancelRatio)
+            {
+                CancelOrderMsg msg {};
+                msg.type = MessageType::CancelOrder;
+                msg.order_id = recent[slot];
+                std::memcpy(msg.symbol, symbols[recentSymbol[slot]].data(), sizeof(msg.symbol));
+                std::memcpy(frame, &msg, sizeof(msg));
+                used += sizeof(msg);
+            }
+            else if (haveTarget && pick < config.cancelRatio + config.modifyRatio)
+            {
+                ModifyOrderMsg msg {};
+                msg.type = MessageType::ModifyOrder;
+                msg.order_id = recent[slot];
+                msg.price = 14900 + random.Next() % 201;
+                msg.quantity = 1 + random.Next() % 100;
+                msg.side = random.Next() & 1;
+                std::memcpy(msg.symbol, symbols[recentSymbol[slot]].data(), sizeof(msg.symbol));
+                std::memcpy(frame, &msg, sizeof(msg));
+                used += sizeof(msg);
+            }
+            else
+            {
+                const std::uint8_t symbol = static_cast<std::uint8_t>(random.Next() % symbols.size());
+                NewOrderMsg msg {};
+                msg.type = MessageType::NewOrder;
+                msg.order_id = nextId++;
+                msg.price = 14900 + random.Next() % 201;
+                msg.quantity = 1 + random.Next() % 100;
+                msg.side = random.Next() & 1;
+                msg.order_type = static_cast<std::uint8_t>(OrderType::GoodTillCancel);
+                std::memcpy(msg.symbol, symbols[symbol].data(), sizeof(msg.symbol));
+                std::memcpy(frame, &msg, sizeof(msg));
+                used += sizeof(msg);
+
+                recent[added & RecentMask] = msg.order_id;
+                recentSymbol[added & RecentMask] = symbol;
+                ++added;
+            }
+            --remaining;
+        }
+        boost::asio::write(socket, boost::asio::buffer(buffer.data(), used));
+    }
+    // Half-close and wait for the server to close its end, which it only does once
+    // it has read every frame, so the pass times ingestion rather than socket buffering.
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_send);
+    char ignored;
+    boost::system::error_code closed;
+    socket.read_some(boost::asio::buffer(&ignored, 1), closed);
+    sent.fetch_add(messages, std::memory_order_relaxed);
+}
+
+// One pass at a fixed connection count; returns messages per second. Connection
+// numbers continue from earlier passes, so order ids never repeat across them.
+double RunPass(const LoadConfig& config, std::size_t connections, std::size_t firstConnection)
+{
+    const std::uint64_t messages = config.total > 0 ? std::max<std::uint64_t>(1, config.total / connections) : config.messages;
+    std::cout << "[LOAD] " << connections << " connections x " << messages << " messages -> "
+              << config.host << ":" << config.port << " (cancel " << config.cancelRatio
+              << ", modify " << config.modifyRatio << ")\n";
+
+    std::atomic<std::uint64_t> sent { 0 };
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < connections; ++i)
+    {
+        threads.emplace_back([&config, &sent, messages, connection = firstConnection + i]()
+        {
+            try { RunConnection(config, messages, connection, sent); }
+            catch (const std::exception& e) { std::cerr << "[LOAD] Connection " << connection << " failed: " << e.what() << "\n"; }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "[LOAD] Sent " << sent.load() << " messages in " << elapsed.count() << " s: "
+              << sent.load() / elapsed.count() << " msg/s\n";
+    return sent.load() / elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        LoadConfig config;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option.starts_with("--host=")) config.host = option.substr(7);
+            else if (option.starts_with("--port=")) config.port = option.substr(7);
+            else if (option.starts_with("--connections=")) {
+                config.connections.clear();
+                for (const auto& count : SplitList(option.substr(14))) config.connections.push_back(std::stoul(count));
+            }
+            else if (option.starts_with("--messages=")) config.messages = std::stoull(option.substr(11));
+            else if (option.starts_with("--total=")) config.total = std::stoull(option.substr(8));
+            else if (option.starts_with("--cancel=")) config.cancelRatio = std::stod(option.substr(9));
+            else if (option.starts_with("--modify=")) config.modifyRatio = std::stod(option.substr(9));
+            else if (option.starts_with("--symbols=")) config.symbols = SplitList(option.substr(10));
+            else {
+                std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+                return 1;
+            }
+        }
+        const bool noConnections = config.connections.empty() ||
+            std::find(config.connections.begin(), config.connections.end(), 0) != config.connections.end();
+        if (noConnections || config.symbols.empty() || config.cancelRatio + config.modifyRatio >= 1.0)
+        {
+            std::cerr << "[ERROR] Need at least one connection and symbol, and cancel + modify below 1\n";
+            return 1;
+        }
+
+        std::vector<double> rates;
+        std::size_t firstConnection = 0;
+        for (std::size_t connections : config.connections)
+        {
+            rates.push_back(RunPass(config, connections, firstConnection));
+            firstConnection += connections;
+        }
+
+        if (config.connections.size() > 1)
+        {
+            std::cout << "\n[LOAD] connections        msg/s\n";
+            for (std::size_t i = 0; i < rates.size(); ++i)
+                std::cout << "[LOAD] " << std::setw(11) << config.connections[i] << std::setw(13) << static_cast<std::uint64_t>(rates[i]) << "\n";
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Fatal Exception: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -2,58 +2,868 @@
 #include <format>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <boost/asio.hpp>
-#include <boost/lockfree/queue.hpp>
 #include "Protocol.h"
 #include "Orderbook.h"
 #include "Order.h"
 #include "OrderType.h"
-#include <fstream>
-#include <cstdio>
 #include "FixedSizePool.h"
+#include "LevelStorage.h"
+#include "Concurrency.h"
+#include "EngineCommand.h"
+#include "BookView.h"
+#include "MarketDataFeed.h"
+#include "Journal.h"
+#include "Checkpoint.h"
+#include "NetworkIngest.h"
+#include "SpscRing.h"
+#include "SymbolRegistry.h"
+#include "CycleClock.h"
+#include "LatencyHistogram.h"
+#include "LatencyReport.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 
-boost::lockfree::queue<NewOrderMsg, boost::lockfree::capacity<65000>> order_queue;
+// One SPSC ring per producer (client connection, benchmark feeder, GFD timer), drained by an engine shard.
+using InboundRings = SpscRingSet<EngineCommand, 16384, 256>;
+constexpr size_t engine_batch_size = 256;
+constexpr int benchmark_orders = 10000000;
+// Matching threads republish the dashboard book's view (into the shared-memory
+// feed in live mode) this often under load, unless --view-every says otherwise.
+constexpr uint64_t view_publish_interval = 65536;
+// Seconds between live checkpoints, unless --checkpoint-every says otherwise.
+constexpr uint64_t default_checkpoint_interval = 60;
 std::atomic<bool> server_running{true};
 std::atomic<uint64_t> engine_processed_count{0};
 std::atomic<uint64_t> network_received_count{0};
+std::atomic<uint64_t> unknown_symbol_count{0};
 
-inline Order* AllocateOrder(MemoryPool<Order>& pool, bool use_pool, OrderId id, uint8_t side, uint64_t price, uint64_t quantity) 
+// Per-operation latency in clock ticks, recorded by whichever thread applies the commands.
+// Wire-to-match runs from the producer stamping NewOrderMsg::timestamp to the match finishing.
+struct LatencyStats
+{
+    LatencyHistogram add_;
+    LatencyHistogram cancel_;
+    LatencyHistogram modify_;
+    LatencyHistogram wireToMatch_;
+    LatencyHistogram publish_;
+
+    LatencyHistogram* For(CommandType type)
+    {
+        switch (type)
+        {
+            case CommandType::NewOrder: return &add_;
+            case CommandType::CancelOrder: return &cancel_;
+            case CommandType::ModifyOrder: return &modify_;
+            default: return nullptr;
+        }
+    }
+
+    void Merge(const LatencyStats& other)
+    {
+        add_.Merge(other.add_);
+        cancel_.Merge(other.cancel_);
+        modify_.Merge(other.modify_);
+        wireToMatch_.Merge(other.wireToMatch_);
+        publish_.Merge(other.publish_);
+    }
+};
+
+// One matching core. It owns a disjoint set of instruments (picked by symbol hash),
+// drains their inbound rings on its own pinned thread, and is the only writer of their books.
+struct EngineShard
+{
+    InboundRings rings_;
+    std::vector<Instrument*> instruments_;
+    std::atomic<bool> running_ { true };
+    std::atomic<uint64_t> processed_ { 0 };
+    LatencyStats latency_;
+    unsigned core_ {};
+    bool releaseIdleChunks_ = false;
+    uint64_t viewInterval_ = view_publish_interval;
+    std::unique_ptr<JournalProducer> journal_; // null unless --journal
+    std::atomic<bool> checkpointRequested_ { false };
+    std::vector<BookCheckpoint> checkpoints_; // one per instrument, captured by the shard's thread on request
+    Timestamp nextExpiry_ = Timestamp::min(); // no book in the shard has an order due before this; min() until first checked
+    std::thread thread_;
+};
+using EngineShards = std::vector<std::unique_ptr<EngineShard>>;
+
+struct EngineConfig
+{
+    bool use_queue = false;
+    bool use_mempool = false;
+    LevelStorage level_storage = LevelStorage::Map;
+    std::vector<std::string> symbols { "AAPL", "TSLA", "MSFT" };
+    size_t shards = 1; // 0 sweeps the benchmark from 1 to the core count
+    bool latency = false;
+    bool huge_pages = false;
+    bool fixed_pool = false;   // hard per-symbol limit instead of growing the order pools
+    bool release_idle = false; // queue mode: engine threads unmap idle pool chunks while their rings are dry
+    uint64_t view_interval = view_publish_interval; // orders between depth view publishes under load
+    size_t io_threads = 1;     // live: network threads driving every client socket
+    bool io_uring = false;     // live: io_uring ingest instead of Asio, when the kernel supports it
+    std::string journal_path;  // queue mode: journal every applied command here; live replays it at start-up
+    std::string checkpoint_path;      // checkpoint every resting order here; live restores it at start-up
+    uint64_t checkpoint_interval = default_checkpoint_interval; // live: seconds between checkpoints
+};
+
+inline Order* AllocateOrder(MemoryPool<Order>& pool, bool use_pool, OrderId id, uint8_t side, uint64_t price, uint64_t quantity, OrderType type = OrderType::GoodTillCancel)
 {
     if (use_pool) {
+        // An exhausted pool counts the miss itself (PoolStats::exhausted); the order is dropped.
         Order* raw_mem = pool.allocate();
-        if (raw_mem == nullptr) throw std::bad_alloc();
-        return new(raw_mem) Order(OrderType::GoodTillCancel, id, static_cast<Side>(side), static_cast<Price>(price), static_cast<Quantity>(quantity));
+        if (raw_mem == nullptr) return nullptr;
+        return new(raw_mem) Order(type, id, static_cast<Side>(side), static_cast<Price>(price), static_cast<Quantity>(quantity));
     } else {
-        return new Order(OrderType::GoodTillCancel, id, static_cast<Side>(side), static_cast<Price>(price), static_cast<Quantity>(quantity));
+        return new Order(type, id, static_cast<Side>(side), static_cast<Price>(price), static_cast<Quantity>(quantity));
+    }
+}
+
+// Applies one command to its instrument's book. Returns false for housekeeping
+// commands that do not count as processed orders.
+bool apply_command(Instrument& instrument, const EngineCommand& command, bool use_mempool)
+{
+    const NewOrderMsg& msg = command.order;
+    OrderBook& orderbook = *instrument.book_;
+    switch (command.type)
+    {
+        case CommandType::NewOrder:
+            if (Order* order = AllocateOrder(*instrument.pool_, use_mempool, msg.order_id, msg.side, msg.price, msg.quantity, static_cast<OrderType>(msg.order_type)))
+                orderbook.AddOrder(order, NullTradeSink {}, Timestamp { std::chrono::nanoseconds { msg.expiry } });
+            return true;
+        case CommandType::CancelOrder:
+            orderbook.CancelOrder(msg.order_id);
+            return true;
+        case CommandType::ModifyOrder:
+            orderbook.ModifyOrder(OrderModify { msg.order_id, static_cast<Side>(msg.side), static_cast<Price>(msg.price), static_cast<Quantity>(msg.quantity) }, NullTradeSink {});
+            return true;
+        case CommandType::ExpireGoodForDay:
+            orderbook.CancelGoodForDayOrders();
+            return false;
+        case CommandType::ExpireOrders:
+            orderbook.ExpireOrders(Timestamp { std::chrono::nanoseconds { msg.expiry } });
+            return false;
+    }
+    return false;
+}
+
+// Times one command. Ticks are converted to nanoseconds only when the report is printed.
+bool apply_command_timed(Instrument& instrument, const EngineCommand& command, bool use_mempool, LatencyStats& latency)
+{
+    const uint64_t start = CycleClock::Now();
+    const bool counted = apply_command(instrument, command, use_mempool);
+    const uint64_t end = CycleClock::Now();
+    if (LatencyHistogram* histogram = latency.For(command.type)) histogram->Record(end - start);
+    if (command.type == CommandType::NewOrder && command.order.timestamp != 0) latency.wireToMatch_.Record(end - command.order.timestamp);
+    return counted;
+}
+
+// Republishes `book`'s top-of-book view from the matching thread. This is all the
+// snapshot path costs there: BookView::Depth levels per side off the level
+// aggregates, copied into the seqlock (and the feed's, when the book mirrors to one).
+void publish_view(OrderBook& book, bool measure_latency, LatencyStats& latency)
+{
+    if (!measure_latency)
+    {
+        book.PublishView();
+        return;
+    }
+    const uint64_t start = CycleClock::Now();
+    book.PublishView();
+    latency.publish_.Record(CycleClock::Now() - start);
+}
+
+void push_all(InboundRings::Ring& ring, const EngineCommand* commands, size_t count)
+{
+    while (count > 0)
+    {
+        size_t pushed = ring.try_push_n(commands, count);
+        commands += pushed;
+        count -= pushed;
+        if (count > 0) std::this_thread::yield();
+    }
+}
+
+// A producer's handle on every shard: one ring and one staging batch per shard,
+// so commands still reach each engine in bulk pushes.
+class ShardFeeder
+{
+    public:
+        explicit ShardFeeder(EngineShards& shards): shards_ { shards }, staged_(shards.size())
+        {
+            for (auto& shard : shards_) rings_.push_back(shard->rings_.Acquire());
+        }
+
+        ~ShardFeeder()
+        {
+            Flush();
+            for (size_t i = 0; i < shards_.size(); ++i) shards_[i]->rings_.Release(rings_[i]);
+        }
+
+        void Post(size_t shard, const EngineCommand& command)
+        {
+            Staged& staged = staged_[shard];
+            staged.commands_[staged.count_++] = command;
+            if (staged.count_ == engine_batch_size) Flush(shard);
+        }
+
+        void Flush()
+        {
+            for (size_t i = 0; i < staged_.size(); ++i) Flush(i);
+        }
+
+    private:
+        struct Staged
+        {
+            std::array<EngineCommand, engine_batch_size> commands_;
+            size_t count_ = 0;
+        };
+
+        EngineShards& shards_;
+        std::vector<InboundRings::Ring*> rings_;
+        std::vector<Staged> staged_;
+
+        void Flush(size_t shard)
+        {
+            Staged& staged = staged_[shard];
+            if (staged.count_ == 0) return;
+            push_all(*rings_[shard], staged.commands_.data(), staged.count_);
+            staged.count_ = 0;
+        }
+};
+
+// Turns the frames one network I/O thread decodes into engine work: in queue
+// mode they go through the thread's own ShardFeeder, so the number of producer
+// rings follows the I/O threads rather than the clients; in sync mode they are
+// matched in place on the (Locked) books.
+class FrameRouter
+{
+    public:
+        FrameRouter(SymbolRegistry& registry, EngineShards& shards, OrderBook& primary_book, bool use_queue, bool use_mempool, uint64_t view_interval):
+        registry_ { registry }, primary_book_ { primary_book }, use_mempool_ { use_mempool }, view_interval_ { view_interval },
+        feeder_ { use_queue ? std::make_unique<ShardFeeder>(shards) : nullptr }
+        {}
+
+        template <typename Message>
+        void operator()(const Message& msg)
+        {
+            ++received_;
+            // The books' order index keeps this id for its empty slots.
+            if (msg.order_id == ReservedOrderId)
+                throw std::runtime_error(std::format("Order id {} is reserved.", msg.order_id));
+            if constexpr (std::is_same_v<Message, NewOrderMsg>)
+            {
+                if (msg.order_type > static_cast<uint8_t>(OrderType::GoodTillTime))
+                    throw std::runtime_error(std::format("Unknown order type ({}) for order {}.", msg.order_type, msg.order_id));
+            }
+
+            Instrument* instrument = registry_.Find(ToSymbolKey(msg.symbol));
+            if (instrument == nullptr)
+            {
+                unknown_symbol_count.fetch_add(1, std::memory_order_relaxed);
+            }
+            else if (feeder_)
+            {
+                feeder_->Post(instrument->shard_, ToCommand(msg));
+            }
+            else
+            {
+                apply_command(*instrument, ToCommand(msg), use_mempool_);
+                instrument->processed_.fetch_add(1, std::memory_order_relaxed);
+
+                uint64_t prev_count = engine_processed_count.fetch_add(1, std::memory_order_relaxed);
+                // The book is Locked in sync mode, so PublishView serializes with the other I/O threads.
+                if ((prev_count + 1) % view_interval_ == 0) primary_book_.PublishView();
+            }
+        }
+
+        // Hands staged commands to the engines and publishes the receive count; once per read.
+        void Flush()
+        {
+            if (feeder_) feeder_->Flush();
+            network_received_count.fetch_add(received_, std::memory_order_relaxed);
+            received_ = 0;
+        }
+
+    private:
+        SymbolRegistry& registry_;
+        OrderBook& primary_book_;
+        bool use_mempool_;
+        uint64_t view_interval_;
+        std::unique_ptr<ShardFeeder> feeder_;
+        uint64_t received_ = 0;
+};
+
+// Keeps an engine shard on one core so its books stay in that core's caches.
+void pin_to_core(std::thread& thread, unsigned core)
+{
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    if (int error = pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus); error != 0)
+        std::cerr << "[WARN] Could not pin engine shard to core " << core << ": " << std::strerror(error) << "\n";
+#else
+    (void)thread;
+    (void)core;
+#endif
+}
+
+// NUMA node that `core` belongs to, or -1 if the kernel does not say.
+int numa_node_of_core(unsigned core)
+{
+#ifdef __linux__
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/cpu/cpu" + std::to_string(core), error))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.starts_with("node")) return std::stoi(name.substr(4));
+    }
+#else
+    (void)core;
+#endif
+    return -1;
+}
+
+EngineShards make_shards(size_t count)
+{
+    EngineShards shards;
+    for (size_t i = 0; i < count; ++i) shards.push_back(std::make_unique<EngineShard>());
+    return shards;
+}
+
+// Every instrument owns its book and pool; the 10M order budget is split evenly between them,
+// as each pool's first chunk (or its hard limit with --fixed-pool).
+// Queue mode funnels every mutation through the owning shard's engine thread, so the books run
+// lock-free and each GoodForDay close is posted to that shard like any other command.
+SymbolRegistry build_registry(const EngineConfig& config, EngineShards& shards)
+{
+    SymbolRegistry registry;
+    const size_t pool_capacity = (benchmark_orders + config.symbols.size() - 1) / config.symbols.size();
+    for (const auto& symbol : config.symbols)
+    {
+        Instrument& instrument = registry.Add(symbol, pool_capacity, PoolOptions { .huge_pages = config.huge_pages, .growable = !config.fixed_pool }, [&](MemoryPool<Order>& pool, SymbolKey key)
+        {
+            EngineShard* shard = shards[ShardOf(key, shards.size())].get();
+            return std::make_unique<OrderBook>(pool, config.use_mempool, config.level_storage,
+                config.use_queue ? Concurrency::SingleWriter : Concurrency::Locked,
+                [shard, key]() {
+                    EngineCommand expire {};
+                    expire.type = CommandType::ExpireGoodForDay;
+                    std::memcpy(expire.order.symbol, &key, sizeof(key));
+                    InboundRings::Ring* ring = shard->rings_.Acquire();
+                    push_all(*ring, &expire, 1);
+                    shard->rings_.Release(ring);
+                });
+        });
+        instrument.shard_ = ShardOf(instrument.key_, shards.size());
+        shards[instrument.shard_]->instruments_.push_back(&instrument);
+    }
+    return registry;
+}
+
+// Expires the good-till-time orders now due in the shard's books. The clock is
+// read once and each expiry is journaled with it like any other command, so
+// replay expires exactly the orders the live engine did. Returns whether any
+// book's clock moved. The books are only visited once the shard's earliest
+// deadline has passed, so a batch with nothing due costs a clock read at most.
+bool expire_due_orders(EngineShard& shard, bool use_mempool)
+{
+    if (shard.nextExpiry_ == Timestamp::max()) return false;
+    const Timestamp now = std::chrono::system_clock::now();
+    if (now < shard.nextExpiry_) return false;
+
+    bool expired = false;
+    Timestamp next = Timestamp::max();
+    for (Instrument* instrument : shard.instruments_)
+    {
+        const Timestamp due = instrument->book_->NextExpiry();
+        if (due > now)
+        {
+            next = std::min(next, due);
+            continue;
+        }
+        EngineCommand expire {};
+        expire.type = CommandType::ExpireOrders;
+        expire.order.expiry = static_cast<uint64_t>(now.time_since_epoch().count());
+        std::memcpy(expire.order.symbol, &instrument->key_, sizeof(instrument->key_));
+        if (shard.journal_) shard.journal_->Post(expire);
+        ++instrument->applied_;
+        apply_command(*instrument, expire, use_mempool);
+        next = std::min(next, instrument->book_->NextExpiry());
+        expired = true;
+    }
+    shard.nextExpiry_ = next;
+    if (expired && shard.journal_) shard.journal_->Flush();
+    return expired;
+}
+
+// Engine loop for one shard. Producers only post symbols they have routed here.
+void run_engine_shard(EngineShard& shard, const SymbolRegistry& registry, OrderBook* snapshot_book, bool use_mempool, bool measure_latency)
+{
+    try
+    {
+        EngineCommand batch[engine_batch_size];
+        bool view_stale = false;
+        auto last_release = std::chrono::steady_clock::now();
+        while (shard.running_.load(std::memory_order_relaxed))
+        {
+            uint64_t orders = 0;
+            size_t drained = shard.rings_.Drain(batch, engine_batch_size, [&](const EngineCommand& command)
+            {
+                // Journaled in the order this thread applies them, which is the order replay needs.
+                if (shard.journal_) shard.journal_->Post(command);
+                Instrument& instrument = *registry.Find(ToSymbolKey(command.order.symbol));
+                ++instrument.applied_;
+                const bool counted = measure_latency ? apply_command_timed(instrument, command, use_mempool, shard.latency_)
+                                                     : apply_command(instrument, command, use_mempool);
+                // The book rounds the deadline up to its tick, so this is never late.
+                if (command.type == CommandType::NewOrder && command.order.order_type == static_cast<uint8_t>(OrderType::GoodTillTime))
+                    shard.nextExpiry_ = std::min(shard.nextExpiry_, Timestamp { std::chrono::nanoseconds { command.order.expiry } });
+                if (!counted) return;
+                instrument.processed_.store(instrument.processed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                ++orders;
+            });
+
+            if (drained > 0)
+            {
+                view_stale = true;
+                if (shard.journal_) shard.journal_->Flush();
+
+                // Only this thread writes the shard counter, so a plain store per batch replaces the fetch_add.
+                uint64_t previous = shard.processed_.load(std::memory_order_relaxed);
+                uint64_t processed = previous + orders;
+                shard.processed_.store(processed, std::memory_order_relaxed);
+                engine_processed_count.fetch_add(orders, std::memory_order_relaxed);
+                // The shard owning the dashboard's symbol keeps its view fresh under load
+                if (snapshot_book != nullptr && processed / shard.viewInterval_ != previous / shard.viewInterval_)
+                    publish_view(*snapshot_book, measure_latency, shard.latency_);
+            }
+            else
+            {
+                // Refresh the readers' views while the rings are dry.
+                if (view_stale)
+                {
+                    for (Instrument* instrument : shard.instruments_) instrument->book_->PublishView();
+                    view_stale = false;
+                }
+                // Only this thread touches the shard's pools, which is what ReleaseIdleChunks needs.
+                if (shard.releaseIdleChunks_ && std::chrono::steady_clock::now() - last_release > std::chrono::seconds(1))
+                {
+                    for (Instrument* instrument : shard.instruments_) instrument->pool_->ReleaseIdleChunks();
+                    last_release = std::chrono::steady_clock::now();
+                }
+                std::this_thread::yield();
+            }
+            if (expire_due_orders(shard, use_mempool)) view_stale = true;
+
+            // Between batches every book sits on a command boundary, and the journal
+            // has been handed every command the capture includes.
+            if (shard.checkpointRequested_.load(std::memory_order_acquire))
+            {
+                for (size_t i = 0; i < shard.instruments_.size(); ++i)
+                {
+                    const Instrument& instrument = *shard.instruments_[i];
+                    BookCheckpoint& checkpoint = shard.checkpoints_[i];
+                    instrument.book_->Checkpoint(checkpoint);
+                    checkpoint.key_ = instrument.key_;
+                    checkpoint.applied_ = instrument.applied_;
+                }
+                shard.checkpointRequested_.store(false, std::memory_order_release);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "\n[FATAL] Engine Shard died: " << e.what() << "\n";
+        server_running = false;
+    }
+}
+
+void start_shards(EngineShards& shards, const SymbolRegistry& registry, OrderBook& primary_book, bool use_mempool, bool measure_latency = false,
+                  bool release_idle = false, uint64_t view_interval = view_publish_interval, JournalWriter* journal = nullptr)
+{
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        EngineShard& shard = *shards[i];
+        OrderBook* snapshot_book = i == registry[0].shard_ ? &primary_book : nullptr;
+        shard.core_ = static_cast<unsigned>(i % cores);
+        shard.releaseIdleChunks_ = release_idle;
+        shard.viewInterval_ = view_interval;
+        if (journal != nullptr) shard.journal_ = std::make_unique<JournalProducer>(*journal);
+        shard.checkpoints_.resize(shard.instruments_.size());
+        // Pool pages are only touched once the shard allocates, so they can still be steered to its node.
+        if (const int node = numa_node_of_core(shard.core_); node >= 0)
+        {
+            for (Instrument* instrument : shard.instruments_)
+            {
+                if (!instrument->pool_->BindToNode(node))
+                {
+                    std::cerr << "[WARN] Could not bind " << instrument->name_ << " pool to NUMA node " << node << "\n";
+                    break;
+                }
+            }
+        }
+        shard.thread_ = std::thread(run_engine_shard, std::ref(shard), std::cref(registry), snapshot_book, use_mempool, measure_latency);
+        pin_to_core(shard.thread_, shard.core_);
+    }
+}
+
+void stop_shards(EngineShards& shards)
+{
+    for (auto& shard : shards) shard->running_ = false;
+    for (auto& shard : shards)
+    {
+        if (shard->thread_.joinable()) shard->thread_.join();
+        shard->journal_.reset(); // hands its last commands to the journal writer
+    }
+}
+
+// Loads the checkpoint at `path` into the registry's empty books on the calling
+// thread, before any engine thread starts. Books of symbols not configured are skipped.
+void restore_checkpoint(const std::string& path, SymbolRegistry& registry)
+{
+    uint64_t orders = 0;
+    uint64_t skipped = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const CheckpointFile file(path);
+    for (const auto& book : file.Books())
+    {
+        Instrument* instrument = registry.Find(book.key_);
+        if (instrument == nullptr)
+        {
+            ++skipped;
+            continue;
+        }
+        instrument->book_->Restore(book.view_);
+        instrument->applied_ = book.applied_;
+        orders += book.view_.orders_.size();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    for (size_t i = 0; i < registry.Size(); ++i) registry[i].book_->PublishView();
+
+    std::cout << "[RECOVERY] Restored " << orders << " resting orders from " << path << " in " << elapsed.count() * 1000.0
+              << " ms (" << (elapsed.count() > 0 ? orders / elapsed.count() : 0.0) << " orders/s)";
+    if (skipped > 0) std::cout << "; " << skipped << " books for symbols not configured were skipped";
+    std::cout << "\n";
+}
+
+// Rebuilds the books from the journal at `path` on the calling thread, before any
+// engine thread starts, and returns how many records were valid. After a restored
+// checkpoint, each symbol's first applied_ records are already in its book and are
+// skipped; either way applied_ ends up counting the symbol's records in the journal.
+uint64_t replay_journal(const std::string& path, SymbolRegistry& registry, bool use_mempool)
+{
+    uint64_t skipped = 0;
+    uint64_t covered = 0;
+    std::vector<uint64_t> checkpointed(registry.Size());
+    for (size_t i = 0; i < registry.Size(); ++i) checkpointed[i] = std::exchange(registry[i].applied_, 0);
+
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t replayed = ReplayJournal(path, [&](const EngineCommand& command)
+    {
+        Instrument* instrument = registry.Find(ToSymbolKey(command.order.symbol));
+        if (instrument == nullptr) ++skipped;
+        else if (++instrument->applied_ <= checkpointed[instrument->index_]) ++covered;
+        else apply_command(*instrument, command, use_mempool);
+    });
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    for (size_t i = 0; i < registry.Size(); ++i)
+    {
+        registry[i].book_->PublishView();
+        if (registry[i].applied_ < checkpointed[i])
+            std::cerr << "[WARN] " << path << " holds fewer " << registry[i].name_ << " commands than the checkpoint; the checkpoint stands\n";
+    }
+
+    const uint64_t applied = replayed - covered - skipped;
+    std::cout << "[RECOVERY] Replayed " << applied << " journaled commands from " << path << " in " << elapsed.count() * 1000.0
+              << " ms (" << (elapsed.count() > 0 ? applied / elapsed.count() : 0.0) << " msg/s)";
+    if (covered > 0) std::cout << "; " << covered << " already in the checkpoint were skipped";
+    if (skipped > 0) std::cout << "; " << skipped << " for symbols not configured were skipped";
+    std::cout << "\n";
+    return replayed;
+}
+
+// Checkpoints every book while the engine runs. In queue mode each shard captures
+// its own books between two batches, so a shard stalls for its books' capture
+// only, never for the write. The file is written once the journal holds every
+// command the captures include; otherwise a crash could leave a checkpoint ahead
+// of the journal. Sync mode captures each book under its lock from this thread.
+void take_checkpoint(const std::string& path, const SymbolRegistry& registry, EngineShards& shards, bool use_queue,
+                     JournalWriter* journal, std::vector<BookCheckpoint>& sync_checkpoints)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<const BookCheckpoint*> books;
+    if (use_queue)
+    {
+        for (auto& shard : shards) shard->checkpointRequested_.store(true, std::memory_order_release);
+        for (auto& shard : shards)
+        {
+            while (shard->checkpointRequested_.load(std::memory_order_acquire))
+            {
+                if (!server_running) return;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            for (const BookCheckpoint& checkpoint : shard->checkpoints_) books.push_back(&checkpoint);
+        }
+    }
+    else
+    {
+        sync_checkpoints.resize(registry.Size());
+        for (size_t i = 0; i < registry.Size(); ++i)
+        {
+            registry[i].book_->Checkpoint(sync_checkpoints[i]);
+            sync_checkpoints[i].key_ = registry[i].key_;
+            books.push_back(&sync_checkpoints[i]);
+        }
+    }
+    const std::chrono::duration<double, std::milli> captured = std::chrono::steady_clock::now() - start;
+
+    if (journal != nullptr)
+    {
+        const uint64_t posted = journal->Posted();
+        while (journal->Durable() < posted)
+        {
+            if (journal->Failed()) throw std::runtime_error("The journal writer failed, so the checkpoint would not be covered.");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
     }
+    WriteCheckpoint(path, books);
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t orders = 0;
+    for (const BookCheckpoint* book : books) orders += book->orders_.size();
+    std::cout << "[CHECKPOINT] " << orders << " resting orders to " << path << " in " << elapsed.count() << " ms (captured in "
+              << captured.count() << " ms)\n";
 }
 
-void save_book_snapshot(const OrderBook& orderbook)
+// The benchmark stream: every message as a NewOrder. The latency run also modifies
+// and cancels one recent order per ten adds; some of those will already have filled,
+// which is what a live cancel racing a fill looks like too.
+template <typename Handler>
+void for_each_benchmark_command(const std::vector<NewOrderMsg>& messages, bool mixed, Handler&& handler)
 {
-    const auto& info = orderbook.GetOrderInfos();
-    const auto& bids = info.GetBids();
-    const auto& asks = info.GetAsks();
+    for (size_t i = 0; i < messages.size(); ++i)
+    {
+        handler(EngineCommand { CommandType::NewOrder, messages[i] });
+        if (!mixed) continue;
+        if (i % 10 == 4)
+        {
+            EngineCommand modify { CommandType::ModifyOrder, messages[i - 1] };
+            modify.order.quantity *= 2;
+            handler(modify);
+        }
+        else if (i % 10 == 9) handler(EngineCommand { CommandType::CancelOrder, messages[i - 3] });
+    }
+}
 
-    std::ofstream f("book_state.json.temp");
-    f << "{\"bids\":[";
-    for (size_t i = 0; i < bids.size(); ++i)
+void print_latency(const LatencyStats& latency)
+{
+    std::cout << "LATENCY (ns):\n";
+    PrintLatencyHeader(std::cout);
+    PrintLatencyRow(std::cout, "  add", latency.add_);
+    PrintLatencyRow(std::cout, "  cancel", latency.cancel_);
+    PrintLatencyRow(std::cout, "  modify", latency.modify_);
+    PrintLatencyRow(std::cout, "  wire-to-match", latency.wireToMatch_);
+    PrintLatencyRow(std::cout, "  publish view", latency.publish_);
+}
+
+// Checkpoints the benchmark's books once they are quiet and restores the file into
+// a fresh engine, the way a restarted live server loads its last checkpoint.
+void verify_checkpoint(const EngineConfig& config, const SymbolRegistry& registry)
+{
+    std::vector<BookCheckpoint> checkpoints(registry.Size());
+    std::vector<const BookCheckpoint*> books;
+    uint64_t orders = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < registry.Size(); ++i)
     {
-        f << "{\"price\":" << bids[i].price_
-        << ",\"quantity\":" << bids[i].quantity_ << "}";
-        f << (i == bids.size() - 1 ? "" : ",");
+        registry[i].book_->Checkpoint(checkpoints[i]);
+        checkpoints[i].key_ = registry[i].key_;
+        checkpoints[i].applied_ = registry[i].applied_;
+        books.push_back(&checkpoints[i]);
+        orders += checkpoints[i].orders_.size();
     }
-    f << "], \"asks\": [";
-    for (size_t i = 0; i < asks.size(); ++i)
+    const std::chrono::duration<double, std::milli> captured = std::chrono::steady_clock::now() - start;
+    WriteCheckpoint(config.checkpoint_path, books);
+    const std::chrono::duration<double, std::milli> written = std::chrono::steady_clock::now() - start - captured;
+    std::cout << "[CHECKPOINT] Captured " << orders << " resting orders in " << captured.count() << " ms, wrote them to "
+              << config.checkpoint_path << " in " << written.count() << " ms\n";
+
+    EngineShards restored_shards = make_shards(1);
+    SymbolRegistry restored = build_registry(config, restored_shards);
+    restore_checkpoint(config.checkpoint_path, restored);
+    bool matches = true;
+    LevelInfos bids, asks, restored_bids, restored_asks;
+    auto same = [](const LevelInfos& a, const LevelInfos& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+            [](const LevelInfo& x, const LevelInfo& y) { return x.price_ == y.price_ && x.quantity_ == y.quantity_; });
+    };
+    for (size_t i = 0; i < registry.Size(); ++i)
     {
-        f << "{\"price\":" << asks[i].price_
-        << ",\"quantity\":" << asks[i].quantity_ << "}";
-        f << (i == asks.size() - 1 ? "" : ",");
+        registry[i].book_->GetDepth(std::numeric_limits<size_t>::max(), bids, asks);
+        restored[i].book_->GetDepth(std::numeric_limits<size_t>::max(), restored_bids, restored_asks);
+        if (restored[i].book_->Size() == registry[i].book_->Size() && same(bids, restored_bids) && same(asks, restored_asks)) continue;
+        std::cout << "[CHECKPOINT] " << registry[i].name_ << " restored " << restored[i].book_->Size() << " resting orders, expected "
+                  << registry[i].book_->Size() << ", or its depth differs\n";
+        matches = false;
     }
-    f << "]}";
-    f.close();
-    std::rename("book_state.json.temp", "book_state.json");
+    if (matches) std::cout << "[CHECKPOINT] Every restored book matches the benchmark's, level by level.\n";
+}
+
+// Fires the same pre-built orders through a freshly built engine and reports
+// aggregate, per-shard and per-symbol throughput, plus per-operation latency
+// percentiles when asked.
+void run_benchmark(const EngineConfig& config, size_t shard_count, const std::vector<NewOrderMsg>& messages)
+{
+    const auto build_start = std::chrono::steady_clock::now();
+    EngineShards shards = make_shards(config.use_queue ? shard_count : 1);
+    SymbolRegistry registry = build_registry(config, shards);
+    OrderBook& primary_book = *registry[0].book_;
+    // A fresh journal per run; it is replayed into a second engine once the run is over.
+    std::unique_ptr<JournalWriter> journal;
+    if (!config.journal_path.empty())
+    {
+        journal = std::make_unique<JournalWriter>(config.journal_path, 0);
+        journal->Start();
+    }
+    if (config.use_queue) start_shards(shards, registry, primary_book, config.use_mempool, config.latency, false, config.view_interval, journal.get());
+    const std::chrono::duration<double, std::milli> build_time = std::chrono::steady_clock::now() - build_start;
+    std::cout << "[BENCHMARK] Engine built in " << build_time.count() << " ms (order pools: "
+              << (registry[0].pool_->UsesHugeTlb() ? "hugetlbfs" : config.huge_pages ? "transparent huge pages" : "4 KB pages") << ")\n";
+    // Warm the clock calibration up front so it never lands inside the timed loop.
+    if (config.latency) CycleClock::NanosPerTick();
+    LatencyStats latency;
+    uint64_t commands = 0;
+
+    std::cout << "[BENCHMARK] Firing into engine...\n";
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (config.use_queue)
+    {
+        // QUEUE MODE: Main thread routes each order to its symbol's shard, engine threads pop
+        {
+            ShardFeeder feeder(shards);
+            for_each_benchmark_command(messages, config.latency, [&](EngineCommand command) {
+                const Instrument& instrument = *registry.Find(ToSymbolKey(command.order.symbol));
+                // The feeder stands in for the wire: stamp as the order leaves the producer
+                if (config.latency) command.order.timestamp = CycleClock::Now();
+                feeder.Post(instrument.shard_, command);
+                ++commands;
+            });
+        }
+        // Wait for every shard to finish draining its rings
+        auto processed = [&shards]() {
+            uint64_t total = 0;
+            for (const auto& shard : shards) total += shard->processed_.load(std::memory_order_relaxed);
+            return total;
+        };
+        while (processed() < commands) {
+            std::this_thread::yield();
+        }
+    }
+    else
+    {
+        // SYNC MODE: Main thread bypasses queue and matches directly
+        for_each_benchmark_command(messages, config.latency, [&](const EngineCommand& command) {
+            Instrument* instrument = registry.Find(ToSymbolKey(command.order.symbol));
+            if (config.latency) apply_command_timed(*instrument, command, config.use_mempool, latency);
+            else apply_command(*instrument, command, config.use_mempool);
+            instrument->processed_.fetch_add(1, std::memory_order_relaxed);
+            if (++commands % config.view_interval == 0) publish_view(primary_book, config.latency, latency);
+        });
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration_seconds = end_time - start_time;
+    stop_shards(shards);
+    for (const auto& shard : shards) latency.Merge(shard->latency_);
+    if (journal)
+    {
+        const auto drain_start = std::chrono::steady_clock::now();
+        journal->Stop();
+        const std::chrono::duration<double, std::milli> drain_time = std::chrono::steady_clock::now() - drain_start;
+        if (journal->Failed()) throw std::runtime_error(std::format("Journal writer failed: {}", journal->Error()));
+        std::cout << "[BENCHMARK] Journaled " << journal->Appended() << " commands in " << journal->Commits() << " group commits (avg "
+                  << journal->Appended() / std::max<uint64_t>(1, journal->Commits()) << " per msync); catching up after matching took "
+                  << drain_time.count() << " ms\n";
+    }
+
+    std::cout << "\n========================================\n";
+    std::cout << "CONFIGURATION:\n";
+    std::cout << "Queue: " << (config.use_queue ? "ON" : "OFF") << "\n";
+    std::cout << "MemPool: " << (config.use_mempool ? "ON" : "OFF") << "\n";
+    std::cout << "Levels: " << (config.level_storage == LevelStorage::Ladder ? "LADDER" : "MAP") << "\n";
+    std::cout << "Symbols: " << registry.Size() << "\n";
+    std::cout << "Shards: " << (config.use_queue ? shards.size() : 0) << "\n";
+    std::cout << "Latency: " << (config.latency ? "ON" : "OFF") << "\n";
+    std::cout << "----------------------------------------\n";
+    if (config.use_queue)
+    {
+        for (size_t i = 0; i < shards.size(); ++i)
+        {
+            const EngineShard& shard = *shards[i];
+            std::cout << "  Shard " << i << " (core " << shard.core_ << "): " << shard.processed_.load() << " orders, "
+                      << (shard.processed_.load() / duration_seconds.count()) << " Ops/Sec [";
+            for (const Instrument* instrument : shard.instruments_) std::cout << " " << instrument->name_;
+            std::cout << " ]\n";
+        }
+    }
+    for (size_t i = 0; i < registry.Size(); ++i)
+    {
+        std::cout << "  " << registry[i].name_ << ": " << registry[i].processed_.load() << " orders, "
+                  << registry[i].book_->Size() << " resting";
+        if (config.use_mempool)
+        {
+            const PoolStats pool = registry[i].pool_->Stats();
+            std::cout << " | pool: " << pool.live << " live, " << pool.high_water << " peak, "
+                      << pool.chunks << (pool.chunks == 1 ? " chunk, " : " chunks, ") << pool.exhausted << " exhausted";
+        }
+        std::cout << "\n";
+    }
+    if (config.latency)
+    {
+        std::cout << "----------------------------------------\n";
+        print_latency(latency);
+        std::cout << "----------------------------------------\n";
+    }
+    std::cout << "Processed " << commands << " orders in " << duration_seconds.count() * 1000.0 << " ms.\n";
+    std::cout << "THROUGHPUT: " << (commands / duration_seconds.count()) << " Ops/Sec\n";
+    std::cout << "========================================\n";
+
+    if (journal)
+    {
+        // Recovery into a fresh engine, the way a restarted live server rebuilds its books.
+        EngineShards recovered_shards = make_shards(1);
+        SymbolRegistry recovered = build_registry(config, recovered_shards);
+        replay_journal(config.journal_path, recovered, config.use_mempool);
+        bool matches = true;
+        for (size_t i = 0; i < registry.Size(); ++i)
+        {
+            if (recovered[i].book_->Size() == registry[i].book_->Size()) continue;
+            std::cout << "[RECOVERY] " << registry[i].name_ << " recovered " << recovered[i].book_->Size() << " resting orders, expected "
+                      << registry[i].book_->Size() << "\n";
+            matches = false;
+        }
+        if (matches) std::cout << "[RECOVERY] Every recovered book holds as many resting orders as the benchmark's.\n";
+    }
+    if (!config.checkpoint_path.empty()) verify_checkpoint(config, registry);
 }
 
 int main(int argc, char* argv[])
@@ -61,9 +871,8 @@ int main(int argc, char* argv[])
     try
     {
         bool run_live_server = false; // Set to true for Python TCP, false for pure C++ Benchmark
-        bool use_queue = false;
-        bool use_mempool = false;
-        if (argc == 4) 
+        EngineConfig config;
+        if (argc >= 4)
         {
             std::string mode_arg  = argv[1]; // "live" or "test"
             std::string queue_arg = argv[2]; // "queue" or "sync"
@@ -80,223 +889,340 @@ int main(int argc, char* argv[])
             }
 
             // 2. Set the Hardware Architecture
-            use_queue = (queue_arg == "queue");
-            use_mempool = (pool_arg == "mempool");
-            
-            std::cout << "[INIT] Booting with -> Mode: " << mode_arg 
-                      << " | Threading: " << (use_queue ? "QUEUE" : "SYNC") 
-                      << " | Memory: " << (use_mempool ? "MEMPOOL" : "OS HEAP") << "\n";
+            config.use_queue = (queue_arg == "queue");
+            config.use_mempool = (pool_arg == "mempool");
+
+            // 3. Optional tuning flags
+            for (int i = 4; i < argc; ++i)
+            {
+                std::string option = argv[i];
+                if (option == "--levels=map") config.level_storage = LevelStorage::Map;
+                else if (option == "--levels=ladder") config.level_storage = LevelStorage::Ladder;
+                else if (option.starts_with("--symbols=")) {
+                    config.symbols.clear();
+                    std::string list = option.substr(std::string("--symbols=").size());
+                    for (size_t start = 0; start <= list.size(); ) {
+                        size_t comma = list.find(',', start);
+                        if (comma == std::string::npos) comma = list.size();
+                        if (comma > start) config.symbols.push_back(list.substr(start, comma - start));
+                        start = comma + 1;
+                    }
+                    if (config.symbols.empty()) {
+                        std::cerr << "[ERROR] --symbols needs at least one symbol\n";
+                        return 1;
+                    }
+                }
+                else if (option == "--latency") config.latency = true;
+                else if (option == "--hugepages") config.huge_pages = true;
+                else if (option == "--fixed-pool") config.fixed_pool = true;
+                else if (option == "--release-idle") config.release_idle = true;
+                else if (option.starts_with("--io-threads=")) {
+                    std::string count = option.substr(std::string("--io-threads=").size());
+                    config.io_threads = count.empty() || count.find_first_not_of("0123456789") != std::string::npos ? 0 : std::stoul(count);
+                    if (config.io_threads == 0) {
+                        std::cerr << "[ERROR] --io-threads needs a positive count\n";
+                        return 1;
+                    }
+                }
+                else if (option.starts_with("--journal=")) {
+                    config.journal_path = option.substr(std::string("--journal=").size());
+                    if (config.journal_path.empty()) {
+                        std::cerr << "[ERROR] --journal needs a file path\n";
+                        return 1;
+                    }
+                }
+                else if (option.starts_with("--checkpoint=")) {
+                    config.checkpoint_path = option.substr(std::string("--checkpoint=").size());
+                    if (config.checkpoint_path.empty()) {
+                        std::cerr << "[ERROR] --checkpoint needs a file path\n";
+                        return 1;
+                    }
+                }
+                else if (option.starts_with("--checkpoint-every=")) {
+                    std::string seconds = option.substr(std::string("--checkpoint-every=").size());
+                    config.checkpoint_interval = seconds.empty() || seconds.find_first_not_of("0123456789") != std::string::npos ? 0 : std::stoull(seconds);
+                    if (config.checkpoint_interval == 0) {
+                        std::cerr << "[ERROR] --checkpoint-every needs a positive number of seconds\n";
+                        return 1;
+                    }
+                }
+                else if (option == "--ingest=asio") config.io_uring = false;
+                else if (option == "--ingest=uring") config.io_uring = true;
+                else if (option.starts_with("--view-every=")) {
+                    std::string count = option.substr(std::string("--view-every=").size());
+                    config.view_interval = count.empty() || count.find_first_not_of("0123456789") != std::string::npos ? 0 : std::stoull(count);
+                    if (config.view_interval == 0) {
+                        std::cerr << "[ERROR] --view-every needs a positive order count\n";
+                        return 1;
+                    }
+                }
+                else if (option == "--shards=sweep") config.shards = 0;
+                else if (option.starts_with("--shards=")) {
+                    std::string count = option.substr(std::string("--shards=").size());
+                    config.shards = count.empty() || count.find_first_not_of("0123456789") != std::string::npos ? 0 : std::stoul(count);
+                    if (config.shards == 0) {
+                        std::cerr << "[ERROR] --shards needs a positive count or 'sweep'\n";
+                        return 1;
+                    }
+                }
+                else {
+                    std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+                    return 1;
+                }
+            }
+            if (config.latency && run_live_server) {
+                std::cerr << "[ERROR] --latency only applies to the offline benchmark\n";
+                return 1;
+            }
+            if (config.release_idle && (!run_live_server || !config.use_queue || config.fixed_pool)) {
+                std::cerr << "[ERROR] --release-idle needs the live server in queue mode with growable pools\n";
+                return 1;
+            }
+            if (!config.journal_path.empty() && !config.use_queue) {
+                std::cerr << "[ERROR] --journal needs queue mode, where each engine thread applies its commands in one order\n";
+                return 1;
+            }
+            if (config.checkpoint_interval != default_checkpoint_interval && (!run_live_server || config.checkpoint_path.empty())) {
+                std::cerr << "[ERROR] --checkpoint-every needs the live server with --checkpoint\n";
+                return 1;
+            }
+            if (config.shards == 0 && run_live_server) {
+                std::cerr << "[ERROR] --shards=sweep only applies to the offline benchmark\n";
+                return 1;
+            }
+
+            std::cout << "[INIT] Booting with -> Mode: " << mode_arg
+                      << " | Threading: " << (config.use_queue ? "QUEUE" : "SYNC")
+                      << " | Memory: " << (config.use_mempool ? "MEMPOOL" : "OS HEAP")
+                      << " | Levels: " << (config.level_storage == LevelStorage::Ladder ? "LADDER" : "MAP")
+                      << " | Symbols: " << config.symbols.size()
+                      << " | Shards: " << (config.shards == 0 ? "SWEEP" : std::to_string(config.shards))
+                      << " | Latency: " << (config.latency ? "ON" : "OFF")
+                      << " | Huge pages: " << (config.huge_pages ? "ON" : "OFF")
+                      << " | Pools: " << (config.fixed_pool ? "FIXED" : "GROWABLE")
+                      << " | View every: " << config.view_interval
+                      << " | IO threads: " << config.io_threads
+                      << " | Ingest: " << (config.io_uring ? "IO_URING" : "ASIO")
+                      << " | Journal: " << (config.journal_path.empty() ? "OFF" : config.journal_path)
+                      << " | Checkpoint: " << (config.checkpoint_path.empty() ? "OFF" : config.checkpoint_path) << "\n";
+            if (!config.use_queue && config.shards != 1)
+                std::cout << "[INIT] Sync mode matches on the calling thread; --shards is ignored.\n";
         }
-        else 
+        else
         {
             // Manual if input is incorrect
             std::cerr << "========================================\n";
             std::cerr << "INVALID COMMAND. Usage instructions:\n";
-            std::cerr << "./engine <mode> <threading> <memory>\n";
+            std::cerr << "./engine <mode> <threading> <memory> [options]\n";
             std::cerr << "  <mode>      : live | test\n";
             std::cerr << "  <threading> : queue | sync\n";
-            std::cerr << "  <memory>    : mempool | os\n\n";
-            std::cerr << "Example: ./engine test sync mempool\n";
+            std::cerr << "  <memory>    : mempool | os\n";
+            std::cerr << "  [options]   : --levels=map | --levels=ladder\n";
+            std::cerr << "                --symbols=AAPL,TSLA,MSFT (up to 8 chars each)\n";
+            std::cerr << "                --shards=N (queue mode engine threads) | --shards=sweep (test: 1..cores)\n";
+            std::cerr << "                --latency (test: per-operation p50..p99.99 and wire-to-match)\n";
+            std::cerr << "                --hugepages (back the order pools with 2 MB pages)\n";
+            std::cerr << "                --fixed-pool (hard per-symbol order limit; pools grow by default)\n";
+            std::cerr << "                --release-idle (live queue mode: unmap idle pool chunks)\n";
+            std::cerr << "                --io-threads=N (live: network threads serving all clients; default 1)\n";
+            std::cerr << "                --ingest=asio|uring (live: network back end; uring falls back to asio without kernel support)\n";
+            std::cerr << "                --view-every=N (publish the depth view every N orders; 1 = every engine batch)\n";
+            std::cerr << "                --journal=PATH (queue mode: write-ahead journal of every command; live replays it at start-up)\n";
+            std::cerr << "                --checkpoint=PATH (binary image of every resting order; live restores it at start-up)\n";
+            std::cerr << "                --checkpoint-every=SECONDS (live: how often to checkpoint; default 60)\n\n";
+            std::cerr << "Example: ./engine test sync mempool --levels=ladder\n";
             std::cerr << "========================================\n";
             return 1;
         }
 
-        MemoryPool<Order> order_pool(10000000);
-        OrderBook orderbook(order_pool, use_mempool);
-        std::thread engine_thread;
-
-        // Start the Engine Thread
-        if (use_queue)
-        {
-            engine_thread = std::thread([&orderbook, &order_pool, use_mempool]() {
-                try 
-                {
-                    NewOrderMsg msg;
-                    while (server_running) 
-                    {
-                        if (order_queue.pop(msg)) 
-                        {
-                            Order* new_order = AllocateOrder(order_pool, use_mempool, msg.order_id, msg.side, msg.price, msg.quantity);
-                            orderbook.AddOrder(new_order);
-                            
-                            // Update every 250k processed orders
-                            uint64_t prev_count = engine_processed_count.fetch_add(1, std::memory_order_relaxed);
-                            if ((prev_count+1) % 250000 == 0)
-                            {
-                                save_book_snapshot(orderbook);
-                            }
-                        } 
-                        else 
-                        {
-                            std::this_thread::yield();
-                        }
-                    }
-                } 
-                catch (const std::exception& e) 
-                {
-                    std::cerr << "\n[FATAL] Engine Thread died: " << e.what() << "\n";
-                    server_running = false;
-                }
-            });
-        }
-
         if (run_live_server)
         {
+            EngineShards shards = make_shards(config.use_queue ? config.shards : 1);
+            SymbolRegistry registry = build_registry(config, shards);
+            // The dashboard's depth chart follows the first symbol.
+            OrderBook& primary_book = *registry[0].book_;
+            // Depth and counters go out through shared memory; the book's writer publishes the depth straight into it.
+            char primary_symbol[8];
+            std::memcpy(primary_symbol, &registry[0].key_, sizeof(primary_symbol));
+            MarketDataFeed feed(primary_symbol);
+            primary_book.MirrorViewTo(&feed.Book());
+            std::cout << "[INIT] Market data feed at /dev/shm" << feed.Name() << "\n";
+            // Recover from the last checkpoint and the journal after it before any engine
+            // thread runs, then keep appending to the journal.
+            if (!config.checkpoint_path.empty() && std::filesystem::exists(config.checkpoint_path))
+                restore_checkpoint(config.checkpoint_path, registry);
+            std::unique_ptr<JournalWriter> journal;
+            if (!config.journal_path.empty())
+            {
+                const uint64_t recovered = replay_journal(config.journal_path, registry, config.use_mempool);
+                journal = std::make_unique<JournalWriter>(config.journal_path, recovered);
+                journal->Start();
+            }
+            if (config.use_queue) start_shards(shards, registry, primary_book, config.use_mempool, false, config.release_idle, config.view_interval, journal.get());
+            const uint64_t view_interval = config.view_interval;
+            const bool use_queue = config.use_queue;
+            const bool use_mempool = config.use_mempool;
+
             // Start the Metrics Thread
-            std::thread metrics_thread([]()
+            std::thread metrics_thread([&registry, &shards, &feed, &journal, use_queue]()
             {
                 uint64_t last_network_count = 0;
                 uint64_t last_engine_count = 0;
+                std::vector<uint64_t> last_symbol_counts(registry.Size(), 0);
+                std::vector<uint64_t> last_shard_counts(shards.size(), 0);
                 while (server_running)
                 {
                     std::this_thread::sleep_for(std::chrono::seconds(1));
                     uint64_t current_network_count = network_received_count.load();
                     uint64_t current_engine_count = engine_processed_count.load();
-                    uint64_t network_ops_per_second = current_network_count - last_network_count;
-                    uint64_t engine_ops_per_second = current_engine_count - last_engine_count;
 
-                    std::ofstream f("metrics.json.temp");
-                    f << "{\"network_ops\":" << network_ops_per_second
-                    << ", \"engine_ops\": " << engine_ops_per_second 
-                    << ", \"total_network\": " << current_network_count 
-                    << ", \"total_engine\": " << current_engine_count << "}"; 
-                    f.close();
-                    std::rename("metrics.json.temp", "metrics.json");
+                    FeedCounters counters;
+                    counters.networkOps_ = current_network_count - last_network_count;
+                    counters.engineOps_ = current_engine_count - last_engine_count;
+                    counters.totalNetwork_ = current_network_count;
+                    counters.totalEngine_ = current_engine_count;
+                    counters.unknownSymbol_ = unknown_symbol_count.load();
+                    counters.symbolCount_ = static_cast<uint32_t>(std::min(registry.Size(), FeedCounters::MaxSymbols));
+                    for (size_t i = 0; i < counters.symbolCount_; ++i)
+                    {
+                        uint64_t current_symbol_count = registry[i].processed_.load();
+                        const PoolStats pool = registry[i].pool_->Stats();
+                        FeedSymbol& symbol = counters.symbols_[i];
+                        std::memcpy(symbol.symbol_, &registry[i].key_, sizeof(symbol.symbol_));
+                        symbol.engineOps_ = current_symbol_count - last_symbol_counts[i];
+                        symbol.totalEngine_ = current_symbol_count;
+                        symbol.poolLive_ = pool.live;
+                        symbol.poolHighWater_ = pool.high_water;
+                        symbol.poolChunks_ = pool.chunks;
+                        symbol.poolExhausted_ = pool.exhausted;
+                        last_symbol_counts[i] = current_symbol_count;
+                    }
+                    counters.shardCount_ = use_queue ? static_cast<uint32_t>(std::min(shards.size(), FeedCounters::MaxShards)) : 0;
+                    for (size_t i = 0; i < counters.shardCount_; ++i)
+                    {
+                        uint64_t current_shard_count = shards[i]->processed_.load();
+                        counters.shards_[i] = FeedShard { shards[i]->core_, current_shard_count - last_shard_counts[i], current_shard_count };
+                        last_shard_counts[i] = current_shard_count;
+                    }
+                    feed.PublishCounters(counters);
+                    if (journal && journal->Failed())
+                    {
+                        std::cerr << "\n[FATAL] Journal writer died: " << journal->Error() << "\n";
+                        server_running = false;
+                    }
 
                     last_network_count = current_network_count;
                     last_engine_count = current_engine_count;
                 }
             });
 
+            std::thread checkpoint_thread;
+            if (!config.checkpoint_path.empty())
+            {
+                checkpoint_thread = std::thread([&registry, &shards, &journal, &config]()
+                {
+                    std::vector<BookCheckpoint> sync_checkpoints;
+                    auto next = std::chrono::steady_clock::now() + std::chrono::seconds(config.checkpoint_interval);
+                    while (server_running)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                        if (std::chrono::steady_clock::now() < next) continue;
+                        try { take_checkpoint(config.checkpoint_path, registry, shards, config.use_queue, journal.get(), sync_checkpoints); }
+                        catch (const std::exception& e) { std::cerr << "[WARN] Checkpoint failed: " << e.what() << "\n"; }
+                        next = std::chrono::steady_clock::now() + std::chrono::seconds(config.checkpoint_interval);
+                    }
+                });
+            }
+
             boost::asio::io_context io_context;
             boost::asio::ip::tcp::acceptor acceptor(io_context, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), 8080));
-            while (server_running)
+            auto make_router = [&]() { return FrameRouter(registry, shards, primary_book, use_queue, use_mempool, view_interval); };
+
+            // A fixed set of I/O threads runs every client socket. io_uring threads accept
+            // for themselves on the shared listening socket; without io_uring the main thread accepts.
+            std::vector<std::unique_ptr<UringIngestThread<FrameRouter>>> uring_threads;
+            if (config.io_uring)
             {
-                auto socket = std::make_shared<boost::asio::ip::tcp::socket>(io_context);
-                // blocks main thread until python client connects
-                boost::system::error_code accept_error;
-                acceptor.accept(*socket, accept_error);
-                if (accept_error) 
+                try
                 {
-                    std::cerr << "Accept error: " << accept_error.message() << "\n";
-                    continue;
+                    for (size_t i = 0; i < config.io_threads; ++i)
+                        uring_threads.push_back(std::make_unique<UringIngestThread<FrameRouter>>(make_router(), acceptor.native_handle()));
                 }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "[WARN] io_uring ingest unavailable, falling back to Asio: " << e.what() << "\n";
+                    uring_threads.clear();
+                }
+            }
 
-                std::thread client_thread([socket, &orderbook, &order_pool, use_queue, use_mempool]()
+            if (!uring_threads.empty())
+            {
+                for (auto& io_thread : uring_threads) io_thread->Start();
+                while (server_running) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                for (auto& io_thread : uring_threads) io_thread->Stop();
+            }
+            else
+            {
+                std::vector<std::unique_ptr<AsioIngestThread<FrameRouter>>> io_threads;
+                for (size_t i = 0; i < config.io_threads; ++i)
                 {
-                    try
-                    {
-                        char data[65536];
-                        size_t leftover = 0;
-                        while (server_running)
-                        {
-                            boost::system::error_code error;
-                            size_t length = socket->read_some(boost::asio::buffer(data + leftover, sizeof(data) - leftover), error);
-                            if (error == boost::asio::error::eof || error == boost::asio::error::connection_reset)
-                            {
-                                std::cout << "[NETWORK] Client Disconnected.\n";
-                                break;
-                            }
-                            else if (error) throw boost::system::system_error(error);
-
-                            // Calculate exactly how many WHOLE messages we received
-                            size_t total_bytes = leftover + length;
-                            size_t num_messages = total_bytes / sizeof(NewOrderMsg);
-                            size_t consumed_bytes = num_messages * sizeof(NewOrderMsg);
-
-                            size_t offset = 0;
-                            for (size_t i = 0; i < num_messages; ++i)
-                            {
-                                NewOrderMsg* msg = reinterpret_cast<NewOrderMsg*>(&data[offset]);
-                                network_received_count.fetch_add(1, std::memory_order_relaxed);
-                                if (use_queue) 
-                                {
-                                    while (!order_queue.push(*msg)) std::this_thread::yield();
-                                }
-                                else
-                                {
-                                    Order* order = AllocateOrder(order_pool, use_mempool, msg->order_id, msg->side, msg->price, msg->quantity);
-                                    orderbook.AddOrder(order);
-                                    
-                                    uint64_t prev_count = engine_processed_count.fetch_add(1, std::memory_order_relaxed);
-                                    if ((prev_count + 1) % 250000 == 0)
-                                    {
-                                        save_book_snapshot(orderbook);
-                                    }
-                                }
-
-                                offset += sizeof(NewOrderMsg);
-                            }
-                            leftover = total_bytes - consumed_bytes;
-                            if (leftover > 0) std::memmove(data, data + consumed_bytes, leftover);
-                        }
-                    }
-                    catch(const std::exception& e)
+                    io_threads.push_back(std::make_unique<AsioIngestThread<FrameRouter>>(make_router()));
+                    io_threads.back()->Start();
+                }
+
+                size_t next_io_thread = 0;
+                while (server_running)
+                {
+                    // Hand connections to the I/O threads in turn; the socket is bound to its thread's io_context.
+                    AsioIngestThread<FrameRouter>& io_thread = *io_threads[next_io_thread];
+                    next_io_thread = (next_io_thread + 1) % io_threads.size();
+                    boost::system::error_code accept_error;
+                    boost::asio::ip::tcp::socket socket = acceptor.accept(io_thread.Context(), accept_error);
+                    if (accept_error)
                     {
-                        std::cerr << "[NETWORK] Client Thread Exception: " << e.what() << "\n";
+                        std::cerr << "Accept error: " << accept_error.message() << "\n";
+                        continue;
                     }
-                    
-                });
-                client_thread.detach();
+                    io_thread.Serve(std::move(socket));
+                }
+                for (auto& io_thread : io_threads) io_thread->Stop();
             }
             if (metrics_thread.joinable()) metrics_thread.join();
+            if (checkpoint_thread.joinable()) checkpoint_thread.join();
+            stop_shards(shards);
+            if (journal) journal->Stop();
         }
         else
         {
             std::cout << "[INIT] Booting Offline Hardware Benchmark...\n";
             std::cout << "[BENCHMARK] Generating 10,000,000 orders in memory...\n";
-            std::vector<NewOrderMsg> dummy_messages(10000000);
-            for (int i = 0; i < 10000000; i++) {
+            std::vector<SymbolKey> keys;
+            for (const auto& symbol : config.symbols) keys.push_back(ToSymbolKey(symbol));
+            std::vector<NewOrderMsg> dummy_messages(benchmark_orders);
+            for (int i = 0; i < benchmark_orders; i++) {
                 dummy_messages[i].type = MessageType::NewOrder;
                 dummy_messages[i].order_id = i;
                 dummy_messages[i].side = (i % 2 == 0) ? static_cast<uint8_t>(Side::Buy) : static_cast<uint8_t>(Side::Sell);
                 dummy_messages[i].price = 100 + (i % 10);
                 dummy_messages[i].quantity = 10;
+                std::memcpy(dummy_messages[i].symbol, &keys[i % keys.size()], sizeof(SymbolKey));
             }
 
-            std::cout << "[BENCHMARK] Firing into engine...\n";
-            auto start_time = std::chrono::high_resolution_clock::now();
-
-            if (use_queue) 
-            {
-                // QUEUE MODE: Main thread pushes, Engine thread pops
-                for (int i = 0; i < 10000000; i++) {
-                    while (!order_queue.push(dummy_messages[i])) std::this_thread::yield();
-                }
-                // Wait for engine thread to finish draining the queue
-                while (engine_processed_count.load(std::memory_order_relaxed) < 10000000) {
-                    std::this_thread::yield();
-                }
-            } 
-            else 
+            if (config.shards != 0 || !config.use_queue) run_benchmark(config, config.shards, dummy_messages);
+            else
             {
-                // SYNC MODE: Main thread bypasses queue and matches directly
-                for (int i = 0; i < 10000000; i++) {
-                    Order* order = AllocateOrder(order_pool, use_mempool, dummy_messages[i].order_id, dummy_messages[i].side, dummy_messages[i].price, dummy_messages[i].quantity);
-                    orderbook.AddOrder(order);
-                }
+                // Scale the engine from one shard up to one per core on identical input
+                const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+                for (unsigned shard_count = 1; shard_count <= cores; ++shard_count) run_benchmark(config, shard_count, dummy_messages);
             }
-
-            auto end_time = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double> duration_seconds = end_time - start_time;
-
-            std::cout << "\n========================================\n";
-            std::cout << "CONFIGURATION:\n";
-            std::cout << "Queue: " << (use_queue ? "ON" : "OFF") << "\n";
-            std::cout << "MemPool: " << (use_mempool ? "ON" : "OFF") << "\n";
-            std::cout << "----------------------------------------\n";
-            std::cout << "Processed 10,000,000 orders in " << duration_seconds.count() * 1000.0 << " ms.\n";
-            std::cout << "THROUGHPUT: " << (10000000.0 / duration_seconds.count()) << " Ops/Sec\n";
-            std::cout << "========================================\n";
         }
         // shutdown
         server_running = false;
-        if (engine_thread.joinable()) engine_thread.join();
     }
     catch (const std::exception& e)
     {
         std::cerr << "Fatal Exception in Main: " << e.what() << "\n";
     }
-    
+
     return 0;
-}
\ No newline at end of file
+}
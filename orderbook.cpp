@@ -1,5 +1,6 @@
 #include "Orderbook.h"
-#include <numeric>
+#include <limits>
+#include <array>
 #include <chrono>
 #include <ctime>
 
@@ -14,57 +15,41 @@ void OrderBook::DestroyOrder(OrderPointer order)
     else delete order;
 }
 
- bool OrderBook::CanMatch(Side side, Price price) const
+template <typename Bids, typename Asks>
+ bool OrderBook::CanMatch(const Bids& bids, const Asks& asks, Side side, Price price) const
  {
     if (side == Side::Buy)
     {
-        if (asks_.empty()) return false;
-        const auto& [bestAsk, _] = *asks_.begin();
-        return price >= bestAsk;
+        if (asks.Empty()) return false;
+        return price >= asks.BestPrice();
     }
     else
     {
-        if (bids_.empty()) return false;
-        const auto& [bestBid, _] = *bids_.begin();
-        return price <= bestBid;
+        if (bids.Empty()) return false;
+        return price <= bids.BestPrice();
     }
  }
 
- bool OrderBook::CanFullyFill(Side side, Price price, Quantity quantity) const
+template <typename Bids, typename Asks>
+ bool OrderBook::CanFullyFill(const Bids& bids, const Asks& asks, Side side, Price price, Quantity quantity) const
  {
-    if (!CanMatch(side, price)) return false;
+    if (!CanMatch(bids, asks, side, price)) return false;
 
-    std::optional<Price> threshold;
-
-    if (side == Side::Buy)
-    {
-        const auto [askPrice, _] = *asks_.begin();
-        threshold = askPrice;
-    }
-    else
-    {
-        const auto [bidPrice, _] = *bids_.begin();
-        threshold = bidPrice;
-    }
-
-    for (const auto& [levelPrice, levelData] : data_)
-    {
-        if (threshold.has_value() &&
-            ((side == Side::Sell && threshold.value() > levelPrice) ||
-            (side == Side::Buy && threshold.value() < levelPrice))) continue;
-
-        if (quantity <= levelData.quantity_) return true;
-        quantity -= levelData.quantity_;
-    }
-    return false;
+    // Ladder levels answer from their depth index; map levels walk from the best one.
+    if (side == Side::Buy) return asks.HasDepth(price, quantity);
+    return bids.HasDepth(price, quantity);
  }
 
-void OrderBook::PruneGoodForDay()
+// The book's timer thread. It wakes for each 16:00 GoodForDay close and, in
+// Locked mode, whenever a good-till-time order comes due; AddOrder wakes it
+// early if an order due before its alarm rests.
+void OrderBook::PruneExpiredOrders()
 {
     using namespace std::chrono;
     const auto end = hours(16);
 
-    while (true)
+    std::unique_lock ordersLock { ordersMutex_ };
+    while (!shutdown_.load(std::memory_order_acquire))
     {
         const auto now = system_clock::now();
         const auto now_c = system_clock::to_time_t(now);
@@ -77,270 +62,510 @@ void OrderBook::PruneGoodForDay()
         now_parts.tm_min = 0;
         now_parts.tm_sec = 0;
 
-        auto next = system_clock::from_time_t(mktime(&now_parts));
-        auto till = next - now + milliseconds(100);
+        const Timestamp close = system_clock::from_time_t(mktime(&now_parts)) + milliseconds(100);
+        pruneWakeAt_ = close;
+        if (concurrency_ == Concurrency::Locked) pruneWakeAt_ = std::min(close, expiry_.NextDue());
+
+        // A notify is shutdown or an earlier deadline: either way, look again.
+        if (pruneConditionVariable_.wait_until(ordersLock, pruneWakeAt_) == std::cv_status::no_timeout) continue;
+        if (shutdown_.load(std::memory_order_acquire)) return;
 
+        ordersLock.unlock();
+        const Timestamp woke = system_clock::now();
+        if (woke < close)
         {
-            std::unique_lock ordersLock { ordersMutex_ };
-            if (shutdown_.load(std::memory_order_acquire) || 
-                shutdownConditionVariable_.wait_for(ordersLock, till) == std::cv_status::no_timeout)
-                return;
+            if (concurrency_ == Concurrency::Locked) ExpireOrders(woke);
         }
-        
-        OrderIds orderIds;
-
+        else if (concurrency_ == Concurrency::SingleWriter)
         {
-            std::scoped_lock ordersLock { ordersMutex_ };
-
-            for (const auto& [orderPrice, entry] : orders_)
-            {
-                const auto& [order, _] = entry;
-                if (order->GetOrderType() != OrderType::GoodForDay) continue;
-                orderIds.push_back(order->GetOrderId());
-            }
+            if (onGoodForDayClose_) onGoodForDayClose_();
         }
-        CancelOrders(orderIds);
+        else CancelGoodForDayOrders();
+        ordersLock.lock();
     }
 }
 
-
-OrderBook::OrderBook(MemoryPool<Order>& pool, bool use_mempool) : ordersPruneThread_{ [this] {PruneGoodForDay(); }},
-                    orderPool_(pool), useMempool_(use_mempool) { }
-
-void OrderBook::CancelOrderInternal(OrderId orderId)
+void OrderBook::CancelGoodForDayOrders()
 {
-    if (!orders_.contains(orderId)) return;
-    const auto [order, iterator] = orders_.at(orderId);
-    orders_.erase(orderId);
-            
-    if (order->GetOrderSide() == Side::Sell)
+    auto ordersLock = LockOrders();
+    VisitLevels([&](auto& bids, auto& asks)
     {
-        auto price = order->GetPrice();
-        auto& orders = asks_.at(price);
-        orders.erase(iterator);
-        if (orders.empty()) asks_.erase(price);
-    }
-    else
-    {
-        auto price = order->GetPrice();
-        auto& orders = bids_.at(price);
-        orders.erase(iterator);
-        if (orders.empty()) bids_.erase(price);
-    }
-    OnOrderCancelled(order);
-    DestroyOrder(order);
+        // Most of the book may go at once, so the depth is summed again afterwards
+        // rather than kept up order by order.
+        expiry_.CloseSession([&](OrderPointer order) { RemoveOrder(bids, asks, order, false); });
+        bids.RebuildDepth();
+        asks.RebuildDepth();
+    });
+    PublishSize();
 }
 
-void OrderBook::OnOrderAdded(OrderPointer order)
+void OrderBook::ExpireOrders(Timestamp now)
 {
-    UpdateLevelData(order->GetPrice(), order->GetRemainingQuantity(), LevelData::Action::Add);
+    auto ordersLock = LockOrders();
+    VisitLevels([&](auto& bids, auto& asks)
+    {
+        expiry_.Advance(now, [&](OrderPointer order) { RemoveOrder(bids, asks, order); });
+    });
+    PublishSize();
 }
 
-void OrderBook::OnOrderCancelled(OrderPointer order)
+Timestamp OrderBook::NextExpiry() const
 {
-    UpdateLevelData(order->GetPrice(), order->GetRemainingQuantity(), LevelData::Action::Remove);
+    auto ordersLock = LockOrders();
+    return expiry_.NextDue();
 }
 
-void OrderBook::OnOrderMatched(Price price, Quantity quantity, bool isFullyFilled)
+OrderBook::OrderBook(MemoryPool<Order>& pool, bool use_mempool, LevelStorage levels,
+                    Concurrency concurrency, std::function<void()> onGoodForDayClose) : levelStorage_(levels),
+                    orders_(pool.Capacity()), expiry_(pool.Capacity()),
+                    orderPool_(pool), useMempool_(use_mempool),
+                    concurrency_(concurrency), onGoodForDayClose_(std::move(onGoodForDayClose)),
+                    ordersPruneThread_{ [this] {PruneExpiredOrders(); }} { }
+
+template <typename Bids, typename Asks>
+void OrderBook::CancelOrderInternal(Bids& bids, Asks& asks, OrderId orderId)
 {
-    UpdateLevelData(price, quantity, isFullyFilled ? LevelData::Action::Remove : LevelData::Action::Match);
+    const auto* entry = orders_.find(orderId);
+    if (entry == nullptr) return;
+    const OrderPointer order = OrderOf(*entry);
+    if (entry->HasExpiry()) expiry_.Remove(entry->Handle());
+    RemoveOrder(bids, asks, order);
 }
 
-void OrderBook::UpdateLevelData(Price price, Quantity quantity, LevelData::Action action)
+// The entry orders_ keeps for a newly resting order, which puts a timed order
+// on the expiry index.
+OrderBook::OrderEntry OrderBook::Track(OrderPointer order, Timestamp expiry)
 {
-    auto& data = data_[price];
+    const OrderType type = order->GetOrderType();
+    if (type == OrderType::GoodForDay) return OrderEntry::Timed(expiry_.AddToSession(order));
+    if (type == OrderType::GoodTillTime) return OrderEntry::Timed(expiry_.Schedule(order, expiry));
+    return OrderEntry::Untimed(order);
+}
 
-    data.count_ += action == LevelData::Action::Remove ? -1 : action == LevelData::Action::Add ? 1 : 0;
-    if (action == LevelData::Action::Remove || action == LevelData::Action::Match)
-    {
-        data.quantity_ -= quantity;
-    }
-    else
+// Takes a resting order out of orders_ and off its level, and frees it. Its
+// expiry entry, if any, is the caller's to drop, as is a RebuildDepth if it
+// passes changeDepth = false.
+template <typename Bids, typename Asks>
+void OrderBook::RemoveOrder(Bids& bids, Asks& asks, OrderPointer order, bool changeDepth)
+{
+    orders_.erase(order->GetOrderId());
+    auto unlink = [order, changeDepth](auto& levels)
     {
-        data.quantity_ += quantity;
-    }
-    if (data.count_ == 0) data_.erase(price);
+        const Price price = order->GetPrice();
+        auto& orders = levels.At(price);
+        orders.erase(order);
+        if (changeDepth) levels.ChangeDepth(price, -static_cast<std::int64_t>(order->GetRemainingQuantity()));
+        if (orders.empty()) levels.Erase(price);
+    };
+    if (order->GetOrderSide() == Side::Sell) unlink(asks);
+    else unlink(bids);
+    DestroyOrder(order);
 }
 
-Trades OrderBook::AddOrder(OrderPointer order)
+void OrderBook::CancelOrderInternal(OrderId orderId)
 {
-    std::scoped_lock ordersLock { ordersMutex_ };
+    VisitLevels([&](auto& bids, auto& asks) { CancelOrderInternal(bids, asks, orderId); });
+}
 
-    if (orders_.contains(order->GetOrderId())) return {};
+Trades OrderBook::AddOrder(OrderPointer order, Timestamp expiry)
+{
+    Trades trades;
+    AddOrder(order, TradeCollector { trades }, expiry);
+    return trades;
+}
+
+template <typename Sink>
+void OrderBook::AddOrder(OrderPointer order, Sink sink, Timestamp expiry)
+{
+    auto ordersLock = LockOrders();
+    VisitLevels([&](auto& bids, auto& asks) { AddOrder(bids, asks, order, sink, expiry); });
+    PublishSize();
+}
 
-    if (order->GetOrderType() == OrderType::Market)
+template <typename Bids, typename Asks, typename Sink>
+void OrderBook::AddOrder(Bids& bids, Asks& asks, OrderPointer order, Sink& sink, Timestamp expiry)
+{
+    // The book owns every order it is handed, so a rejected one is released here.
+    if (order->GetOrderId() == ReservedOrderId || orders_.contains(order->GetOrderId())) { DestroyOrder(order); return; }
+
+    const OrderType type = order->GetOrderType();
+    if (type == OrderType::GoodTillTime && expiry <= expiry_.Now()) { DestroyOrder(order); return; }
+    // An order that may rest is turned away before it trades if its level could not be made.
+    const bool mayRest = type != OrderType::Market && type != OrderType::FillAndKill && type != OrderType::FillOrKill;
+    if (mayRest && !(order->GetOrderSide() == Side::Buy ? bids.CanHold(order->GetPrice()) : asks.CanHold(order->GetPrice())))
     {
-        if (order->GetOrderSide() == Side::Buy && !asks_.empty())
-        {
-            const auto& [worstAsk, _] = *asks_.rbegin();
-            order->ToGoodTillCancel(worstAsk);
-        }
-        else if (order->GetOrderSide() == Side::Sell && !bids_.empty())
-        {
-            const auto& [worstBid, _] = *bids_.rbegin();
-            order->ToGoodTillCancel(worstBid);
-        }
-        return {};
+        DestroyOrder(order);
+        return;
+    }
+    if (type == OrderType::FillOrKill && !CanFullyFill(bids, asks, order->GetOrderSide(), order->GetPrice(), order->GetRemainingQuantity()))
+    {
+        DestroyOrder(order);
+        return;
     }
 
-    if ((order->GetOrderType() == OrderType::FillAndKill)&& !CanMatch(order->GetOrderSide(), order->GetPrice())) return {};
-    if (order->GetOrderType() == OrderType::FillOrKill && !CanFullyFill(order->GetOrderSide(), order->GetPrice(), order->GetInitialQuantity())) return {};
+    // The order trades before it rests, so the book is never crossed. Market and
+    // FillAndKill orders never rest: whatever the sweep leaves of them is dropped.
+    if (order->GetOrderSide() == Side::Buy) Sweep(asks, order, sink);
+    else Sweep(bids, order, sink);
+    if (order->isFilled() || type == OrderType::Market || type == OrderType::FillAndKill)
+    {
+        DestroyOrder(order);
+        return;
+    }
 
-    OrderPointers::iterator iterator;
-    if (order->GetOrderSide() == Side::Buy){
-        auto& orders = bids_[order->GetPrice()];
-        orders.push_back(order);
-        iterator = std::prev(orders.end()); 
+    // The order is indexed before it is linked into its level, and linking is
+    // the last step that can fail, so a throw on the way leaves the book as it
+    // was: what was indexed is rolled back and the order is freed.
+    const Price price = order->GetPrice();
+    const auto quantity = static_cast<std::int64_t>(order->GetRemainingQuantity());
+    auto rest = [&](auto& levels)
+    {
+        levels.GetLevel(price).push_back(order);
+        levels.ChangeDepth(price, quantity);
+    };
+    OrderEntry entry {};
+    try
+    {
+        entry = Track(order, expiry);
+        orders_.insert({ order->GetOrderId(), entry });
+        if (order->GetOrderSide() == Side::Buy) rest(bids);
+        else rest(asks);
     }
-    else
+    catch (...)
     {
-        auto& orders = asks_[order->GetPrice()];
-        orders.push_back(order);
-        iterator = std::prev(orders.end()); 
+        orders_.erase(order->GetOrderId());
+        if (entry.HasExpiry()) expiry_.Remove(entry.Handle());
+        DestroyOrder(order);
+        throw;
     }
-    orders_.insert({ order->GetOrderId(), OrderEntry{ order, iterator }});
-
-    OnOrderAdded(order);
-
-    return MatchOrders();
+    if (type == OrderType::GoodTillTime && concurrency_ == Concurrency::Locked && expiry < pruneWakeAt_)
+        pruneConditionVariable_.notify_one();
 }
 
 Trades OrderBook::ModifyOrder(OrderModify order)
 {
-    OrderType orderType;
-    {
-        std::scoped_lock ordersLock { ordersMutex_ };
-        
-        if (!orders_.contains(order.GetOrderId())) return {};
+    Trades trades;
+    ModifyOrder(order, TradeCollector { trades });
+    return trades;
+}
 
-        const auto& [existingOrder, _] = orders_.at(order.GetOrderId());
-        orderType = existingOrder->GetOrderType();
-    }
+template <typename Sink>
+void OrderBook::ModifyOrder(OrderModify order, Sink sink)
+{
+    auto ordersLock = LockOrders();
 
-    CancelOrder(order.GetOrderId());
-    
-    OrderPointer newOrder = nullptr;
-    if (useMempool_)
+    const auto* entry = orders_.find(order.GetOrderId());
+    if (entry == nullptr) return;
+    const OrderType orderType = OrderOf(*entry)->GetOrderType();
+    const Timestamp expiry = entry->HasExpiry() ? expiry_.DeadlineOf(entry->Handle()) : Timestamp {};
+
+    VisitLevels([&](auto& bids, auto& asks)
     {
-        Order* raw_mem = orderPool_.allocate();
-        if (raw_mem != nullptr) newOrder = new(raw_mem) Order(orderType, order.GetOrderId(), 
-            order.GetSide(), order.GetPrice(), order.GetQuantity());
-    }
-    else newOrder = new Order(orderType, order.GetOrderId(), 
-            order.GetSide(), order.GetPrice(), order.GetQuantity());
-    if (newOrder == nullptr) return {};
-    return AddOrder(newOrder);
+        CancelOrderInternal(bids, asks, order.GetOrderId());
+
+        OrderPointer newOrder = nullptr;
+        if (useMempool_)
+        {
+            Order* raw_mem = orderPool_.allocate();
+            if (raw_mem != nullptr) newOrder = new(raw_mem) Order(orderType, order.GetOrderId(), 
+                order.GetSide(), order.GetPrice(), order.GetQuantity());
+        }
+        else newOrder = new Order(orderType, order.GetOrderId(), 
+                order.GetSide(), order.GetPrice(), order.GetQuantity());
+        if (newOrder == nullptr) return;
+        AddOrder(bids, asks, newOrder, sink, expiry);
+    });
+    PublishSize();
 }
 
-Trades OrderBook::MatchOrders()
+// Trades an incoming order against the opposite side, best level first, while
+// its price crosses (a Market order crosses every level) and it has quantity
+// left. A level it outlasts is taken whole: every resting order there fills
+// completely, so the walk only reports and frees them, and the level goes in
+// one step with its aggregate reset once rather than per fill. Only the last
+// level reached is filled order by order. Each side of a trade carries its
+// own order's price; a Market order takes the level's.
+template <typename Levels, typename Sink>
+void OrderBook::Sweep(Levels& levels, OrderPointer order, Sink& sink)
 {
-    Trades trades;
-    while (true)
+    const Side side = order->GetOrderSide();
+    const bool market = order->GetOrderType() == OrderType::Market;
+    auto report = [&](OrderId restingId, Price price, Quantity quantity)
     {
-        if (bids_.empty() || asks_.empty()) break;
-        auto& [bidPrice, bids] = *bids_.begin();
-        auto& [askPrice, asks] = *asks_.begin();
-        
-        if (bidPrice < askPrice) break;
-
-        while (bids.size() && asks.size()){
-            auto bid = bids.front();
-            auto ask = asks.front();
-
-            Quantity quantity = std::min(bid->GetRemainingQuantity(), ask->GetRemainingQuantity());
-
-            bid->Fill(quantity);
-            ask->Fill(quantity);
+        const TradeInfo taker { order->GetOrderId(), market ? price : order->GetPrice(), quantity };
+        const TradeInfo maker { restingId, price, quantity };
+        if (side == Side::Buy) sink(Trade { taker, maker });
+        else sink(Trade { maker, taker });
+    };
 
-            bool bidFilled = bid->isFilled();
-            bool askFilled = ask->isFilled();
-            OrderId bidId = bid->GetOrderId();
-            OrderId askId = ask->GetOrderId();
-            Price bidPriceMatch = bid->GetPrice();
-            Price askPriceMatch = ask->GetPrice();
+    while (!order->isFilled() && !levels.Empty())
+    {
+        const Price price = levels.BestPrice();
+        if (!market && (side == Side::Buy ? price > order->GetPrice() : price < order->GetPrice())) break;
+        OrderPointers& level = levels.BestLevel();
 
-            if (bidFilled) 
+        if (order->GetRemainingQuantity() >= level.quantity())
+        {
+            order->Fill(level.quantity());
+            levels.ChangeDepth(price, -static_cast<std::int64_t>(level.quantity()));
+            for (auto next = level.begin(); next != level.end(); )
             {
-                bids.pop_front();
-                orders_.erase(bidId);
+                const OrderPointer resting = *next++;
+                const OrderId restingId = resting->GetOrderId();
+                if (HasExpiry(resting->GetOrderType())) expiry_.Remove(orders_.find(restingId)->Handle());
+                orders_.erase(restingId);
+                report(restingId, price, resting->GetRemainingQuantity());
+                DestroyOrder(resting);
             }
-            if (askFilled) 
+            level.reset();
+            levels.Erase(price);
+            continue;
+        }
+
+        // The level outlasts the order, so it stays.
+        levels.ChangeDepth(price, -static_cast<std::int64_t>(order->GetRemainingQuantity()));
+        while (!order->isFilled())
+        {
+            const OrderPointer resting = level.front();
+            const Quantity quantity = std::min(order->GetRemainingQuantity(), resting->GetRemainingQuantity());
+            order->Fill(quantity);
+            level.fill(resting, quantity);
+            const OrderId restingId = resting->GetOrderId();
+            const bool filled = resting->isFilled();
+            if (filled)
             {
-                asks.pop_front();
-                orders_.erase(askId);
+                level.pop_front();
+                if (HasExpiry(resting->GetOrderType())) expiry_.Remove(orders_.find(restingId)->Handle());
+                orders_.erase(restingId);
             }
-            trades.push_back( Trade{ 
-                TradeInfo{bidId, bidPriceMatch, quantity}, 
-                TradeInfo{askId, askPriceMatch, quantity}});
+            report(restingId, price, quantity);
+            if (filled) DestroyOrder(resting);
+        }
+    }
+}
 
-            OnOrderMatched(bidPriceMatch, quantity, bidFilled);
-            OnOrderMatched(askPriceMatch, quantity, askFilled);
+void OrderBook::CancelOrder(OrderId orderId)
+{
+    auto ordersLock = LockOrders();
+    CancelOrderInternal(orderId);
+    PublishSize();
+}
 
-            if (bidFilled) DestroyOrder(bid);
-            if (askFilled) DestroyOrder(ask);
+OrderBookLevelInfos OrderBook::GetOrderInfos() const{
+    LevelInfos bidInfos, askInfos;
+    GetDepth(std::numeric_limits<std::size_t>::max(), bidInfos, askInfos);
+    return OrderBookLevelInfos {bidInfos, askInfos};
+}
 
-        }
+void OrderBook::GetDepth(std::size_t levels, LevelInfos& bids, LevelInfos& asks) const
+{
+    auto ordersLock = LockOrders();
 
-        if (bids.empty()) bids_.erase(bidPrice);
-        if (asks.empty()) asks_.erase(askPrice);
+    bids.clear();
+    asks.clear();
+    if (levels == 0) return;
+    VisitLevels([&](const auto& bidLevels, const auto& askLevels)
+    {
+        bidLevels.ForEachLevel([&](Price price, const OrderPointers& orders)
+        {
+            bids.push_back(LevelInfo { price, orders.quantity() });
+            return bids.size() < levels;
+        });
+        askLevels.ForEachLevel([&](Price price, const OrderPointers& orders)
+        {
+            asks.push_back(LevelInfo { price, orders.quantity() });
+            return asks.size() < levels;
+        });
+    });
+}
 
-    }
+template <typename Levels>
+void OrderBook::CaptureLevels(const Levels& levels, std::vector<CheckpointLevel>& out, std::vector<CheckpointOrder>& orders)
+{
+    // Each queue is a linked list whose orders sit wherever the pool put them, so
+    // walking one costs a cache miss per order. Walking Lanes queues at once keeps
+    // that many misses in flight; each queue's slice of `orders` is known up front
+    // from its size.
+    constexpr std::size_t Lanes = 16;
+    struct Lane
+    {
+        OrderPointers::iterator next_;
+        CheckpointOrder* out_;
+        CheckpointOrder* end_;
+    };
 
-    if (!bids_.empty())
+    std::vector<const OrderPointers*> queues;
+    std::size_t total = 0;
+    levels.ForEachLevel([&](Price price, const OrderPointers& level)
     {
-        auto& [_, bids] = *bids_.begin();
-        auto& order = bids.front();
-        if (order->GetOrderType() == OrderType::FillAndKill)
-        {
-            CancelOrder(order->GetOrderId());
-        }
-    }
-    if (!asks_.empty())
+        out.push_back(CheckpointLevel { price, static_cast<std::uint32_t>(level.size()) });
+        queues.push_back(&level);
+        total += level.size();
+    });
+    const std::size_t first = orders.size();
+    orders.resize(first + total);
+
+    CheckpointOrder* cursor = orders.data() + first;
+    std::size_t nextQueue = 0;
+    auto refill = [&](Lane& lane)
     {
-        auto& [_, asks] = *asks_.begin();
-        auto& order = asks.front();
-        if (order->GetOrderType() == OrderType::FillAndKill)
+        if (nextQueue == queues.size()) return false;
+        const OrderPointers& queue = *queues[nextQueue++];
+        lane = Lane { queue.begin(), cursor, cursor + queue.size() };
+        cursor += queue.size();
+        return true;
+    };
+
+    std::array<Lane, Lanes> lanes;
+    std::size_t active = 0;
+    while (active < Lanes && refill(lanes[active])) ++active;
+    while (active > 0)
+    {
+        for (std::size_t i = 0; i < active; )
         {
-            CancelOrder(order->GetOrderId());
+            Lane& lane = lanes[i];
+            const OrderPointer order = *lane.next_++;
+            *lane.out_++ = CheckpointOrder { order->GetOrderId(), order->GetRemainingQuantity(), static_cast<std::uint8_t>(order->GetOrderType()) };
+            if (lane.out_ != lane.end_) __builtin_prefetch(*lane.next_);
+            else if (!refill(lane))
+            {
+                lane = lanes[--active];
+                continue;
+            }
+            ++i;
         }
     }
-    return trades;
 }
 
-void OrderBook::CancelOrder(OrderId orderId)
+void OrderBook::Checkpoint(BookCheckpoint& checkpoint) const
 {
-    std::scoped_lock ordersLock { ordersMutex_ };
-    CancelOrderInternal(orderId);
+    auto ordersLock = LockOrders();
+
+    checkpoint.bids_.clear();
+    checkpoint.asks_.clear();
+    checkpoint.orders_.clear();
+    checkpoint.orders_.reserve(orders_.size());
+    VisitLevels([&](const auto& bids, const auto& asks)
+    {
+        CaptureLevels(bids, checkpoint.bids_, checkpoint.orders_);
+        CaptureLevels(asks, checkpoint.asks_, checkpoint.orders_);
+    });
+    checkpoint.expiries_.clear();
+    for (const CheckpointOrder& order : checkpoint.orders_)
+    {
+        if (order.type_ == static_cast<std::uint8_t>(OrderType::GoodTillTime))
+            checkpoint.expiries_.push_back(expiry_.DeadlineOf(orders_.find(order.orderId_)->Handle()).time_since_epoch().count());
+    }
 }
 
-void OrderBook::CancelOrders(OrderIds orderIds)
+template <typename Levels>
+const CheckpointOrder* OrderBook::RestoreLevels(Levels& levels, Side side, std::span<const CheckpointLevel> records,
+    const CheckpointOrder* orders, const CheckpointOrder* last, std::span<const std::int64_t>& expiries)
 {
-    std::scoped_lock ordersLock { ordersMutex_ };
-    for (const auto& order : orderIds)
+    // Ids a queue apart hash far apart, so every insert would wait on a cache miss without the prefetch.
+    constexpr std::ptrdiff_t PrefetchDistance = 16;
+    for (const CheckpointLevel& record : records)
     {
-        OrderBook::CancelOrderInternal(order);
+        OrderPointers& level = levels.GetLevel(record.price_);
+        // A price may repeat, and its level then already holds (and counts) the earlier records' orders.
+        const auto before = level.quantity();
+        // Never leave an empty level behind: the matching code assumes every level has a front order.
+        auto reject = [&](const std::string& reason)
+        {
+            levels.ChangeDepth(record.price_, static_cast<std::int64_t>(level.quantity() - before));
+            if (level.empty()) levels.Erase(record.price_);
+            throw std::runtime_error(reason);
+        };
+        for (const CheckpointOrder* end = orders + record.orders_; orders != end; ++orders)
+        {
+            if (last - orders > PrefetchDistance) orders_.prefetch(orders[PrefetchDistance].orderId_);
+            const auto type = static_cast<OrderType>(orders->type_);
+            if (orders->quantity_ == 0 || orders->orderId_ == ReservedOrderId || orders->type_ > static_cast<std::uint8_t>(OrderType::GoodTillTime))
+                reject(std::format("Checkpointed order ({}) is malformed.", orders->orderId_));
+            Timestamp expiry {};
+            if (type == OrderType::GoodTillTime)
+            {
+                if (expiries.empty()) reject(std::format("Checkpointed order ({}) has no expiry.", orders->orderId_));
+                expiry = Timestamp { std::chrono::nanoseconds { expiries.front() } };
+                expiries = expiries.subspan(1);
+                if (expiry <= expiry_.Now()) reject(std::format("Checkpointed order ({}) has already expired.", orders->orderId_));
+            }
+            // Claim the id first, so a duplicate is caught before anything is allocated for it.
+            const auto [entry, inserted] = orders_.insert({ orders->orderId_, OrderEntry {} });
+            if (!inserted) reject(std::format("Checkpointed order ({}) is already in the book.", orders->orderId_));
+
+            OrderPointer order = nullptr;
+            if (useMempool_)
+            {
+                Order* raw_mem = orderPool_.allocate();
+                if (raw_mem != nullptr) order = new(raw_mem) Order(type, orders->orderId_, side, record.price_, orders->quantity_);
+            }
+            else order = new Order(type, orders->orderId_, side, record.price_, orders->quantity_);
+            if (order == nullptr)
+            {
+                orders_.erase(orders->orderId_);
+                reject(std::format("Order pool ran out restoring order ({}).", orders->orderId_));
+            }
+            *entry = Track(order, expiry);
+            level.push_back(order);
+        }
+        levels.ChangeDepth(record.price_, static_cast<std::int64_t>(level.quantity() - before));
+        if (level.empty()) levels.Erase(record.price_);
     }
+    return orders;
 }
 
-OrderBookLevelInfos OrderBook::GetOrderInfos() const{
-    LevelInfos bidInfos, askInfos;
-    bidInfos.reserve(orders_.size());
-    askInfos.reserve(orders_.size());
+void OrderBook::Restore(const CheckpointView& checkpoint)
+{
+    auto ordersLock = LockOrders();
+
+    if (!orders_.empty()) throw std::logic_error("Only an empty book can be restored from a checkpoint.");
+    std::size_t expected = 0;
+    for (const auto& level : checkpoint.bids_) expected += level.orders_;
+    for (const auto& level : checkpoint.asks_) expected += level.orders_;
+    if (expected != checkpoint.orders_.size())
+        throw std::runtime_error(std::format("Checkpoint levels hold {} orders but {} were saved.", expected, checkpoint.orders_.size()));
 
-    auto CreateLevelInfos = [](Price price, const OrderPointers& orders)
+    orders_.reserve(expected);
+    VisitLevels([&](auto& bids, auto& asks)
     {
-        return LevelInfo { price, std::accumulate(orders.begin(), orders.end(), (Quantity)0,
-        [](Quantity runningSum, const OrderPointer& order){ return runningSum + order->GetRemainingQuantity(); }) };
-    };
+        const CheckpointOrder* last = checkpoint.orders_.data() + checkpoint.orders_.size();
+        std::span<const std::int64_t> expiries = checkpoint.expiries_;
+        const CheckpointOrder* next = RestoreLevels(bids, Side::Buy, checkpoint.bids_, checkpoint.orders_.data(), last, expiries);
+        RestoreLevels(asks, Side::Sell, checkpoint.asks_, next, last, expiries);
+        if (!expiries.empty())
+            throw std::runtime_error(std::format("Checkpoint holds {} expiries that no GoodTillTime order claims.", expiries.size()));
+    });
+    PublishSize();
+}
 
-    for (const auto& [price, orders] : bids_) bidInfos.push_back(CreateLevelInfos(price, orders));
-    for (const auto& [price, orders] : asks_) askInfos.push_back(CreateLevelInfos(price, orders));
+void OrderBook::PublishView()
+{
+    auto ordersLock = LockOrders();
 
-    return OrderBookLevelInfos {bidInfos, askInfos};
+    BookView view;
+    view.orders_ = orders_.size();
+    VisitLevels([&](const auto& bids, const auto& asks)
+    {
+        bids.ForEachLevel([&](Price price, const OrderPointers& orders)
+        {
+            view.bids_[view.bidLevels_++] = LevelInfo { price, orders.quantity() };
+            return view.bidLevels_ < BookView::Depth;
+        });
+        asks.ForEachLevel([&](Price price, const OrderPointers& orders)
+        {
+            view.asks_[view.askLevels_++] = LevelInfo { price, orders.quantity() };
+            return view.askLevels_ < BookView::Depth;
+        });
+    });
+    view_.Store(view);
+    if (viewMirror_ != nullptr) viewMirror_->Store(view);
 }
 
 std::size_t OrderBook::Size() const 
 { 
+    if (concurrency_ == Concurrency::SingleWriter) return publishedSize_.load(std::memory_order_acquire);
+
     std::scoped_lock ordersLock { ordersMutex_ };
     return orders_.size(); 
 }
@@ -348,13 +573,26 @@ std::size_t OrderBook::Size() const
 
 OrderBook::~OrderBook()
 {
-    shutdown_.store(true, std::memory_order_release);
-	shutdownConditionVariable_.notify_one();
+    {
+        // Publish under the mutex so the pruner cannot miss the wakeup between its check and its wait.
+        std::scoped_lock ordersLock { ordersMutex_ };
+        shutdown_.store(true, std::memory_order_release);
+    }
+	pruneConditionVariable_.notify_one();
 	ordersPruneThread_.join();
 
     for (auto& [id, entry] : orders_)
     {
-        DestroyOrder(entry.order_);
+        DestroyOrder(OrderOf(entry));
     }
     orders_.clear();
-}
\ No newline at end of file
+}
+
+template void OrderBook::AddOrder(OrderPointer, NullTradeSink, Timestamp);
+template void OrderBook::AddOrder(OrderPointer, TradeCollector, Timestamp);
+template void OrderBook::AddOrder(OrderPointer, TradeRingSink, Timestamp);
+template void OrderBook::AddOrder(OrderPointer, TradeCallback, Timestamp);
+template void OrderBook::ModifyOrder(OrderModify, NullTradeSink);
+template void OrderBook::ModifyOrder(OrderModify, TradeCollector);
+template void OrderBook::ModifyOrder(OrderModify, TradeRingSink);
+template void OrderBook::ModifyOrder(OrderModify, TradeCallback);
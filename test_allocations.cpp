@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include "Order.h"
+#include "PriceLevels.h"
+#include "Orderbook.h"
+#include "FixedSizePool.h"
+
+// Counts every call to the global operator new while armed, so a test can
+// assert that a steady-state loop never reaches the general-purpose heap. It
+// can also be made to fail every allocation, to check what a throw leaves behind.
+// Every replaceable form goes through the same counter: Order and the ring and
+// seqlock types are over-aligned, so they use the align_val_t overloads.
+namespace
+{
+    std::atomic<bool> countingAllocations { false };
+    std::atomic<std::size_t> allocationCount { 0 };
+    std::atomic<bool> failingAllocations { false };
+
+    class AllocationCounter
+    {
+        public:
+            AllocationCounter() { allocationCount = 0; countingAllocations = true; }
+            ~AllocationCounter() { countingAllocations = false; }
+            std::size_t Count() const { return allocationCount.load(); }
+    };
+
+    class AllocationFailure
+    {
+        public:
+            AllocationFailure() { failingAllocations = true; }
+            ~AllocationFailure() { failingAllocations = false; }
+    };
+
+    void* Allocate(std::size_t size, std::size_t alignment)
+    {
+        if (countingAllocations.load(std::memory_order_relaxed)) allocationCount.fetch_add(1, std::memory_order_relaxed);
+        if (failingAllocations.load(std::memory_order_relaxed)) throw std::bad_alloc();
+        if (size == 0) size = 1;
+        // aligned_alloc wants the size to be a multiple of the alignment.
+        void* memory = alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? std::malloc(size)
+            : std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+        if (memory == nullptr) throw std::bad_alloc();
+        return memory;
+    }
+}
+
+void* operator new(std::size_t size) { return Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](std::size_t size) { return Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return Allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return Allocate(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+TEST(AllocationTest, CountsEveryFormOfNew)
+{
+    AllocationCounter counter;
+    delete new Order(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10);
+    EXPECT_EQ(counter.Count(), 1);
+    delete[] new int[4];
+    delete[] new Order[2] { { OrderType::GoodTillCancel, 1, Side::Buy, 100, 10 }, { OrderType::GoodTillCancel, 2, Side::Buy, 100, 10 } };
+    delete new std::uint64_t { 0 };
+    EXPECT_EQ(counter.Count(), 4);
+}
+
+TEST(AllocationTest, LevelQueuesDoNotAllocateInSteadyState)
+{
+    constexpr int Levels = 16;
+    constexpr int OrdersPerLevel = 32;
+    MemoryPool<Order> pool(Levels * OrdersPerLevel * 2);
+    PriceLadder<Side::Buy> bids;
+    PriceLadder<Side::Sell> asks;
+    std::vector<Order*> resting;
+    resting.reserve(Levels * OrdersPerLevel);
+
+    auto Rest = [&](OrderId id, Side side, Price price)
+    {
+        Order* order = new(pool.allocate()) Order(OrderType::GoodTillCancel, id, side, price, 10);
+        if (side == Side::Buy) bids.GetLevel(price).push_back(order);
+        else asks.GetLevel(price).push_back(order);
+        return order;
+    };
+
+    // Warm up: size the ladder windows so the loop below never recenters.
+    for (int level = 0; level < Levels; ++level)
+    {
+        Rest(level, Side::Buy, 100 - level);
+        Rest(Levels + level, Side::Sell, 101 + level);
+    }
+
+    AllocationCounter counter;
+    OrderId nextId = 1000;
+    for (int round = 0; round < 100; ++round)
+    {
+        // add
+        for (int i = 0; i < Levels * OrdersPerLevel; ++i)
+            resting.push_back(Rest(nextId++, Side::Buy, 100 - i % Levels));
+
+        // cancel from the middle of each queue
+        for (std::size_t i = 0; i < resting.size(); i += 2)
+        {
+            Order* order = resting[i];
+            auto& level = bids.At(order->GetPrice());
+            level.erase(order);
+            if (level.empty()) bids.Erase(order->GetPrice());
+            order->~Order();
+            pool.deallocate(order);
+        }
+
+        // match: drain the remaining bids front to back, level by level
+        while (!bids.Empty())
+        {
+            Price price = bids.BestPrice();
+            auto& level = bids.BestLevel();
+            Order* order = level.front();
+            level.pop_front();
+            if (level.empty()) bids.Erase(price);
+            order->~Order();
+            pool.deallocate(order);
+        }
+        resting.clear();
+    }
+
+    EXPECT_EQ(counter.Count(), 0);
+}
+
+TEST(AllocationTest, BookAddCancelDoesNotAllocateInSteadyState)
+{
+    constexpr int Resting = 512;
+    MemoryPool<Order> pool(Resting * 2);
+    OrderBook book(pool, true, LevelStorage::Ladder);
+
+    auto Add = [&](OrderId id, Side side, Price price)
+    {
+        book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillCancel, id, side, price, 10));
+    };
+
+    // Warm up: open the price levels used below so the ladder never recenters.
+    for (int i = 0; i < 32; ++i)
+    {
+        Add(i, Side::Buy, 100 - i);
+        Add(32 + i, Side::Sell, 101 + i);
+    }
+    for (int i = 0; i < 64; ++i) book.CancelOrder(i);
+
+    AllocationCounter counter;
+    OrderId nextId = 1000;
+    for (int round = 0; round < 100; ++round)
+    {
+        const OrderId first = nextId;
+        for (int i = 0; i < Resting; ++i)
+        {
+            const bool buy = i % 2 == 0;
+            Add(nextId++, buy ? Side::Buy : Side::Sell, buy ? 100 - i % 32 : 101 + i % 32);
+        }
+        for (OrderId id = first; id < nextId; ++id) book.CancelOrder(id);
+    }
+
+    EXPECT_EQ(counter.Count(), 0);
+    EXPECT_EQ(book.Size(), 0);
+}
+
+TEST(AllocationTest, MatchingIntoNullSinkDoesNotAllocate)
+{
+    constexpr int Resting = 256;
+    MemoryPool<Order> pool(Resting * 2);
+    OrderBook book(pool, true, LevelStorage::Ladder, Concurrency::SingleWriter);
+
+    auto Add = [&](OrderId id, Side side, Price price, Quantity quantity)
+    {
+        book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillCancel, id, side, price, quantity), NullTradeSink {});
+    };
+
+    for (int i = 0; i < 32; ++i) Add(i, Side::Sell, 101 + i, 10);
+    Add(32, Side::Buy, 140, 320);
+
+    AllocationCounter counter;
+    OrderId nextId = 1000;
+    for (int round = 0; round < 100; ++round)
+    {
+        for (int i = 0; i < Resting; ++i) Add(nextId++, Side::Sell, 101 + i % 32, 10);
+        // One buy sweeps every level.
+        Add(nextId++, Side::Buy, 140, Resting * 10);
+    }
+
+    EXPECT_EQ(counter.Count(), 0);
+    EXPECT_EQ(book.Size(), 0);
+}
+
+TEST(AllocationTest, DepthIntoReusedBuffersDoesNotAllocate)
+{
+    MemoryPool<Order> pool(1024);
+    OrderBook book(pool, true, LevelStorage::Map, Concurrency::SingleWriter);
+    for (OrderId id = 0; id < 512; ++id)
+    {
+        const Side side = id % 2 == 0 ? Side::Buy : Side::Sell;
+        const Price price = side == Side::Buy ? 1000 - static_cast<Price>(id / 2 % 100) : 1001 + static_cast<Price>(id / 2 % 100);
+        book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillCancel, id, side, price, 10), NullTradeSink {});
+    }
+
+    LevelInfos bids, asks;
+    bids.reserve(BookView::Depth);
+    asks.reserve(BookView::Depth);
+
+    AllocationCounter counter;
+    for (int i = 0; i < 1000; ++i) book.GetDepth(BookView::Depth, bids, asks);
+
+    EXPECT_EQ(counter.Count(), 0);
+    ASSERT_EQ(bids.size(), BookView::Depth);
+    EXPECT_EQ(bids[0].price_, 1000);
+    EXPECT_EQ(bids[0].quantity_, 30);
+}
+
+// A new map level needs a node from the heap. When that fails, the order must
+// not be left indexed or on the expiry wheel with no level holding it.
+TEST(AllocationTest, FailedAddLeavesTheBookUnchanged)
+{
+    using namespace std::chrono;
+    const Timestamp open = sys_days { year { 2026 } / 3 / 2 } + hours { 9 };
+    MemoryPool<Order> pool(16);
+    OrderBook book(pool, true, LevelStorage::Map, Concurrency::SingleWriter);
+    book.ExpireOrders(open);
+    book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10), NullTradeSink {});
+
+    {
+        AllocationFailure failure;
+        EXPECT_THROW(book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillTime, 2, Side::Buy, 99, 10), NullTradeSink {}, open + seconds { 1 }),
+            std::bad_alloc);
+    }
+    EXPECT_EQ(book.Size(), 1);
+    EXPECT_EQ(pool.Stats().live, 1);
+    EXPECT_EQ(book.NextExpiry(), Timestamp::max());
+    book.CancelOrder(2);
+    EXPECT_EQ(book.Size(), 1);
+
+    // The id is free again once the heap is.
+    book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillTime, 2, Side::Buy, 99, 10), NullTradeSink {}, open + seconds { 1 });
+    EXPECT_EQ(book.Size(), 2);
+    EXPECT_LE(book.NextExpiry(), open + seconds { 1 });
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "Checkpoint.h"
+#include "Orderbook.h"
+#include "FixedSizePool.h"
+
+namespace
+{
+    std::string TestCheckpointPath() { return "/tmp/orderbook_checkpoint_test_" + std::to_string(getpid()); }
+
+    Order* NewOrder(MemoryPool<Order>& pool, OrderType type, OrderId id, Side side, Price price, Quantity quantity)
+    {
+        return new(pool.allocate()) Order(type, id, side, price, quantity);
+    }
+
+    // Two bid and two ask levels, three orders deep at the best bid; order 4 is GoodForDay.
+    void FillBook(OrderBook& book, MemoryPool<Order>& pool)
+    {
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, 1, Side::Buy, 100, 10));
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, 2, Side::Buy, 100, 20));
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, 3, Side::Buy, 100, 30));
+        book.AddOrder(NewOrder(pool, OrderType::GoodForDay, 4, Side::Buy, 99, 40));
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, 5, Side::Sell, 101, 50));
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, 6, Side::Sell, 105, 60));
+    }
+}
+
+class CheckpointTest : public ::testing::TestWithParam<LevelStorage> {};
+
+TEST_P(CheckpointTest, RestoresLevelsQueuesAndTypes)
+{
+    const std::string path = TestCheckpointPath();
+    {
+        MemoryPool<Order> pool(64);
+        OrderBook book(pool, true, GetParam(), Concurrency::SingleWriter);
+        FillBook(book, pool);
+        BookCheckpoint checkpoint;
+        book.Checkpoint(checkpoint);
+        checkpoint.key_ = 7;
+        checkpoint.applied_ = 42;
+        ASSERT_EQ(checkpoint.bids_.size(), 2);
+        EXPECT_EQ(checkpoint.bids_[0].price_, 100);
+        EXPECT_EQ(checkpoint.bids_[0].orders_, 3);
+        ASSERT_EQ(checkpoint.orders_.size(), 6);
+        const BookCheckpoint* books[] = { &checkpoint };
+        WriteCheckpoint(path, books);
+    }
+
+    const CheckpointFile file(path);
+    ASSERT_EQ(file.Books().size(), 1);
+    EXPECT_EQ(file.Books()[0].key_, 7);
+    EXPECT_EQ(file.Books()[0].applied_, 42);
+
+    MemoryPool<Order> pool(64);
+    OrderBook book(pool, true, GetParam(), Concurrency::SingleWriter);
+    book.Restore(file.Books()[0].view_);
+    EXPECT_EQ(book.Size(), 6);
+    const auto infos = book.GetOrderInfos();
+    ASSERT_EQ(infos.GetBids().size(), 2);
+    EXPECT_EQ(infos.GetBids()[0].price_, 100);
+    EXPECT_EQ(infos.GetBids()[0].quantity_, 60);
+    ASSERT_EQ(infos.GetAsks().size(), 2);
+    EXPECT_EQ(infos.GetAsks()[1].price_, 105);
+
+    // A sell sweeping the best bid fills its queue in the original order.
+    const Trades trades = book.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, 7, Side::Sell, 100, 45));
+    ASSERT_EQ(trades.size(), 3);
+    EXPECT_EQ(trades[0].GetBidTrade().orderId_, 1);
+    EXPECT_EQ(trades[1].GetBidTrade().orderId_, 2);
+    EXPECT_EQ(trades[2].GetBidTrade().orderId_, 3);
+    EXPECT_EQ(trades[2].GetBidTrade().quantity_, 15);
+
+    book.CancelGoodForDayOrders();
+    EXPECT_EQ(book.Size(), 3);
+    EXPECT_EQ(book.GetOrderInfos().GetBids().size(), 1);
+    std::remove(path.c_str());
+}
+
+INSTANTIATE_TEST_SUITE_P(LevelStorages, CheckpointTest, ::testing::Values(LevelStorage::Map, LevelStorage::Ladder));
+
+TEST(CheckpointRestoreTest, RejectsABusyBookAndDuplicateIds)
+{
+    MemoryPool<Order> pool(64);
+    OrderBook source(pool, true);
+    FillBook(source, pool);
+    BookCheckpoint checkpoint;
+    source.Checkpoint(checkpoint);
+
+    OrderBook busy(pool, true);
+    busy.AddOrder(NewOrder(pool, OrderType::GoodTillCancel, 99, Side::Buy, 90, 1));
+    EXPECT_THROW(busy.Restore(checkpoint.View()), std::logic_error);
+
+    checkpoint.orders_[4].orderId_ = checkpoint.orders_[0].orderId_;
+    OrderBook target(pool, true);
+    EXPECT_THROW(target.Restore(checkpoint.View()), std::runtime_error);
+    // What loaded before the duplicate stays, and no empty level is left behind.
+    EXPECT_EQ(target.Size(), 4);
+    EXPECT_TRUE(target.GetOrderInfos().GetAsks().empty());
+}
+
+// A price split over two records restores one level, and FillOrKill sees its
+// true depth: the second record's orders alone, not the whole level again.
+TEST(CheckpointRestoreTest, CountsARepeatedPriceOnce)
+{
+    MemoryPool<Order> pool(64);
+    OrderBook source(pool, true);
+    FillBook(source, pool);
+    BookCheckpoint checkpoint;
+    source.Checkpoint(checkpoint);
+    ASSERT_EQ(checkpoint.bids_[0].orders_, 3);
+    checkpoint.bids_.insert(checkpoint.bids_.begin() + 1, CheckpointLevel { 100, 1 });
+    checkpoint.bids_[0].orders_ = 2;
+
+    OrderBook book(pool, true, LevelStorage::Ladder, Concurrency::SingleWriter);
+    book.Restore(checkpoint.View());
+    ASSERT_EQ(book.GetOrderInfos().GetBids()[0].quantity_, 60);
+    EXPECT_TRUE(book.AddOrder(NewOrder(pool, OrderType::FillOrKill, 10, Side::Sell, 100, 61)).empty());
+    EXPECT_EQ(book.Size(), 6);
+    EXPECT_EQ(book.AddOrder(NewOrder(pool, OrderType::FillOrKill, 11, Side::Sell, 100, 60)).size(), 3);
+}
+
+TEST(CheckpointRestoreTest, KeepsGoodTillTimeDeadlines)
+{
+    using namespace std::chrono;
+    const Timestamp open = sys_days { year { 2026 } / 3 / 2 } + hours { 9 };
+    const std::string path = TestCheckpointPath();
+    {
+        MemoryPool<Order> pool(64);
+        OrderBook book(pool, true, LevelStorage::Ladder, Concurrency::SingleWriter);
+        FillBook(book, pool);
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillTime, 7, Side::Sell, 105, 5), open + minutes { 1 });
+        book.AddOrder(NewOrder(pool, OrderType::GoodTillTime, 8, Side::Buy, 99, 5), open + minutes { 2 });
+        BookCheckpoint checkpoint;
+        book.Checkpoint(checkpoint);
+        ASSERT_EQ(checkpoint.expiries_.size(), 2);
+        const BookCheckpoint* books[] = { &checkpoint };
+        WriteCheckpoint(path, books);
+    }
+
+    const CheckpointFile file(path);
+    MemoryPool<Order> pool(64);
+    OrderBook book(pool, true, LevelStorage::Ladder, Concurrency::SingleWriter);
+    book.Restore(file.Books()[0].view_);
+    EXPECT_EQ(book.Size(), 8);
+    book.ExpireOrders(open + minutes { 1 });
+    EXPECT_EQ(book.Size(), 7);
+    book.ExpireOrders(open + minutes { 2 });
+    EXPECT_EQ(book.Size(), 6);
+    EXPECT_EQ(book.NextExpiry(), Timestamp::max());
+
+    // Deadlines the book's clock has already passed are not restored.
+    OrderBook late(pool, true, LevelStorage::Ladder, Concurrency::SingleWriter);
+    late.ExpireOrders(open + minutes { 1 });
+    EXPECT_THROW(late.Restore(file.Books()[0].view_), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(CheckpointFileTest, RejectsForeignAndTruncatedFiles)
+{
+    const std::string path = TestCheckpointPath();
+    BookCheckpoint checkpoint;
+    checkpoint.bids_.push_back(CheckpointLevel { 100, 2 });
+    checkpoint.orders_.resize(2);
+    const BookCheckpoint* books[] = { &checkpoint };
+    WriteCheckpoint(path, books);
+    EXPECT_NO_THROW(CheckpointFile { path });
+
+    ASSERT_EQ(truncate(path.c_str(), sizeof(CheckpointHeader) + sizeof(CheckpointBook) + sizeof(CheckpointLevel) + 8), 0);
+    EXPECT_THROW(CheckpointFile { path }, std::runtime_error);
+
+    FILE* file = std::fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fputs("definitely not a checkpoint, but long enough to hold a whole checkpoint header...", file);
+    std::fclose(file);
+    EXPECT_THROW(CheckpointFile { path }, std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <unordered_map>
+#include "FlatHashMap.h"
+#include "Usings.h"
+
+TEST(FlatHashMapTest, InsertsFindsAndErases)
+{
+    FlatHashMap<OrderId, int> map;
+    map.insert({ 1, 10 });
+    map[2] = 20;
+
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_EQ(map.at(1), 10);
+    EXPECT_EQ(map.at(2), 20);
+    EXPECT_FALSE(map.insert({ 1, 99 }).second);
+
+    EXPECT_EQ(map.erase(1), 1);
+    EXPECT_EQ(map.erase(1), 0);
+    EXPECT_FALSE(map.contains(1));
+    EXPECT_THROW(map.at(1), std::out_of_range);
+}
+
+TEST(FlatHashMapTest, EmptyKeyIsNeverFound)
+{
+    FlatHashMap<OrderId, int> map;
+    map.insert({ 1, 10 });
+    constexpr OrderId empty = std::numeric_limits<OrderId>::max();
+
+    EXPECT_EQ(map.find(empty), nullptr);
+    EXPECT_FALSE(map.contains(empty));
+    EXPECT_THROW(map.at(empty), std::out_of_range);
+    EXPECT_EQ(map.erase(empty), 0);
+    EXPECT_THROW(map.insert({ empty, 99 }), std::invalid_argument);
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_EQ(map.at(1), 10);
+}
+
+TEST(FlatHashMapTest, BackwardShiftKeepsCollidingKeysReachable)
+{
+    // Keys that are multiples of the table size all share one home slot, so
+    // every erase has to shift the rest of the probe run back.
+    FlatHashMap<OrderId, OrderId> map(8);
+    const std::size_t stride = map.capacity();
+    for (OrderId i = 0; i < 8; ++i) map.insert({ i * stride, i });
+
+    map.erase(0);
+    map.erase(3 * stride);
+    for (OrderId i = 0; i < 8; ++i)
+    {
+        if (i == 0 || i == 3) EXPECT_FALSE(map.contains(i * stride));
+        else EXPECT_EQ(map.at(i * stride), i);
+    }
+}
+
+TEST(FlatHashMapTest, MatchesUnorderedMapUnderChurn)
+{
+    FlatHashMap<Price, int> map(64);
+    std::unordered_map<Price, int> reference;
+    std::mt19937 random(42);
+    std::uniform_int_distribution<Price> prices(-500, 500);
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        Price price = prices(random);
+        if (random() % 3 == 0)
+        {
+            EXPECT_EQ(map.erase(price), reference.erase(price));
+        }
+        else
+        {
+            map[price] += i;
+            reference[price] += i;
+        }
+    }
+
+    EXPECT_EQ(map.size(), reference.size());
+    for (const auto& [price, value] : reference) EXPECT_EQ(map.at(price), value);
+    std::size_t visited = 0;
+    for (const auto& [price, value] : map)
+    {
+        EXPECT_EQ(reference.at(price), value);
+        ++visited;
+    }
+    EXPECT_EQ(visited, reference.size());
+}
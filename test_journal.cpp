@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Journal.h"
+
+namespace
+{
+    std::string TestJournalPath() { return "/tmp/orderbook_journal_test_" + std::to_string(getpid()); }
+
+    EngineCommand NewOrder(uint64_t id)
+    {
+        EngineCommand command {};
+        command.type = CommandType::NewOrder;
+        command.order.type = MessageType::NewOrder;
+        command.order.order_id = id;
+        command.order.price = static_cast<uint32_t>(100 + id % 7);
+        command.order.quantity = 10;
+        std::memcpy(command.order.symbol, "AAPL", 4);
+        return command;
+    }
+
+    void Write(const std::string& path, uint64_t kept, uint64_t firstId, uint64_t count, std::size_t initialRecords = 1024)
+    {
+        JournalWriter writer(path, kept, initialRecords);
+        writer.Start();
+        {
+            JournalProducer producer(writer);
+            for (uint64_t id = firstId; id < firstId + count; ++id) producer.Post(NewOrder(id));
+        }
+        writer.Stop();
+        ASSERT_FALSE(writer.Failed()) << writer.Error();
+        EXPECT_EQ(writer.Appended(), count);
+        EXPECT_EQ(writer.Durable(), kept + count);
+        EXPECT_GE(writer.Commits(), 1);
+    }
+
+    std::vector<uint64_t> ReplayIds(const std::string& path)
+    {
+        std::vector<uint64_t> ids;
+        const uint64_t replayed = ReplayJournal(path, [&](const EngineCommand& command) { ids.push_back(command.order.order_id); });
+        EXPECT_EQ(replayed, ids.size());
+        return ids;
+    }
+
+    // Flips one byte of record `index` (0-based), as a torn write would leave it.
+    void Corrupt(const std::string& path, uint64_t index)
+    {
+        const int fd = open(path.c_str(), O_RDWR);
+        ASSERT_GE(fd, 0);
+        const off_t offset = sizeof(JournalHeader) + index * sizeof(JournalRecord) + offsetof(JournalRecord, command_) + 10;
+        char byte = 0;
+        ASSERT_EQ(pread(fd, &byte, 1, offset), 1);
+        byte ^= 0x5A;
+        ASSERT_EQ(pwrite(fd, &byte, 1, offset), 1);
+        close(fd);
+    }
+}
+
+TEST(JournalTest, ReplaysEveryCommandInOrderAcrossGrowth)
+{
+    const std::string path = TestJournalPath();
+    Write(path, 0, 1, 5000, 16); // starts at 16 records, so the file grows nine times
+
+    const std::vector<uint64_t> ids = ReplayIds(path);
+    ASSERT_EQ(ids.size(), 5000);
+    for (uint64_t i = 0; i < ids.size(); ++i) ASSERT_EQ(ids[i], i + 1);
+
+    std::vector<EngineCommand> commands;
+    ReplayJournal(path, [&](const EngineCommand& command) { commands.push_back(command); });
+    const EngineCommand expected = NewOrder(42);
+    EXPECT_EQ(std::memcmp(&commands[41], &expected, sizeof(EngineCommand)), 0);
+    std::remove(path.c_str());
+}
+
+TEST(JournalTest, ReplayStopsAtATornRecordAndAppendingDropsWhatFollowed)
+{
+    const std::string path = TestJournalPath();
+    Write(path, 0, 1, 100);
+    Corrupt(path, 60);
+    EXPECT_EQ(ReplayIds(path).size(), 60);
+
+    // Records 62..100 were intact but come after the torn one, so they must not reappear after new appends.
+    Write(path, 60, 1000, 10);
+    const std::vector<uint64_t> ids = ReplayIds(path);
+    ASSERT_EQ(ids.size(), 70);
+    EXPECT_EQ(ids[59], 60);
+    EXPECT_EQ(ids[60], 1000);
+    EXPECT_EQ(ids[69], 1009);
+    std::remove(path.c_str());
+}
+
+TEST(JournalTest, MissingFileIsEmptyAndForeignFileThrows)
+{
+    const std::string path = TestJournalPath();
+    std::remove(path.c_str());
+    EXPECT_EQ(ReplayIds(path).size(), 0);
+
+    FILE* file = std::fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fputs("definitely not a journal, but long enough to hold a whole journal header......", file);
+    std::fclose(file);
+    EXPECT_THROW(ReplayJournal(path, [](const EngineCommand&) {}), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include "LatencyHistogram.h"
+
+TEST(LatencyHistogramTest, SmallValuesAreExact)
+{
+    LatencyHistogram histogram;
+    for (std::uint64_t value = 1; value <= 100; ++value) histogram.Record(value);
+
+    EXPECT_EQ(histogram.Count(), 100);
+    EXPECT_EQ(histogram.Percentile(50), 50);
+    EXPECT_EQ(histogram.Percentile(99), 99);
+    EXPECT_EQ(histogram.Percentile(100), 100);
+    EXPECT_EQ(histogram.Max(), 100);
+}
+
+TEST(LatencyHistogramTest, LargeValuesStayWithinBucketError)
+{
+    LatencyHistogram histogram;
+    LatencyHistogram tail;
+    for (std::uint64_t i = 0; i < 9990; ++i) histogram.Record(1000);
+    for (std::uint64_t i = 0; i < 10; ++i) tail.Record(5000000);
+    histogram.Merge(tail);
+
+    const std::uint64_t median = histogram.Percentile(50);
+    EXPECT_GE(median, 1000);
+    EXPECT_LE(median, 1000 + 1000 / 64);
+
+    // The top 0.1% is the 5ms tail; p99.9 still lands on the 1us body.
+    EXPECT_LE(histogram.Percentile(99.9), 1000 + 1000 / 64);
+    EXPECT_EQ(histogram.Percentile(99.99), 5000000);
+    EXPECT_EQ(histogram.Max(), 5000000);
+    EXPECT_EQ(histogram.Percentile(0), histogram.Percentile(1));
+}
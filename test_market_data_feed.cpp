@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include "MarketDataFeed.h"
+#include "Orderbook.h"
+#include "OrderType.h"
+
+namespace
+{
+    std::string TestFeedName() { return "/orderbook_feed_test_" + std::to_string(getpid()); }
+    constexpr char BookSymbol[8] = { 'A', 'A', 'P', 'L', 0, 0, 0, 0 };
+}
+
+TEST(MarketDataFeedTest, ReaderSeesTheBooksPublishedViews)
+{
+    MarketDataFeed feed(BookSymbol, TestFeedName());
+    MemoryPool<Order> pool(16);
+    OrderBook book(pool, false, LevelStorage::Ladder, Concurrency::SingleWriter);
+    book.MirrorViewTo(&feed.Book());
+
+    book.AddOrder(new Order(OrderType::GoodTillCancel, 1, Side::Buy, 99, 10), NullTradeSink {});
+    book.AddOrder(new Order(OrderType::GoodTillCancel, 2, Side::Sell, 101, 20), NullTradeSink {});
+    book.PublishView();
+
+    const MarketDataFeedReader reader(TestFeedName());
+    EXPECT_EQ(std::string(reader.Header().bookSymbol_, 4), "AAPL");
+    BookView view = reader.ReadBook();
+    EXPECT_EQ(view.orders_, 2);
+    ASSERT_EQ(view.bidLevels_, 1);
+    ASSERT_EQ(view.askLevels_, 1);
+    EXPECT_EQ(view.bids_[0].price_, 99);
+    EXPECT_EQ(view.asks_[0].quantity_, 20);
+
+    book.CancelOrder(1);
+    book.PublishView();
+    view = reader.ReadBook();
+    EXPECT_EQ(view.orders_, 1);
+    EXPECT_EQ(view.bidLevels_, 0);
+}
+
+TEST(MarketDataFeedTest, CountersRoundTripAndCountUpdates)
+{
+    MarketDataFeed feed(BookSymbol, TestFeedName());
+    const MarketDataFeedReader reader(TestFeedName());
+    EXPECT_EQ(reader.ReadCounters().updates_, 0);
+
+    FeedCounters counters;
+    counters.totalEngine_ = 1234;
+    counters.symbolCount_ = 1;
+    counters.symbols_[0].poolLive_ = 7;
+    feed.PublishCounters(counters);
+    feed.PublishCounters(counters);
+
+    const FeedCounters read = reader.ReadCounters();
+    EXPECT_EQ(read.updates_, 2);
+    EXPECT_EQ(read.totalEngine_, 1234);
+    EXPECT_EQ(read.symbols_[0].poolLive_, 7);
+}
+
+TEST(MarketDataFeedTest, FeedIsGoneOnceTheEngineIsDone)
+{
+    {
+        MarketDataFeed feed(BookSymbol, TestFeedName());
+    }
+    EXPECT_THROW(MarketDataFeedReader { TestFeedName() }, std::runtime_error);
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+#include "FixedSizePool.h"
+
+namespace
+{
+    struct Block
+    {
+        std::uint64_t owner;
+        std::uint64_t sequence;
+    };
+
+    // Drains the pool on the calling thread; every block must be distinct.
+    std::size_t DrainAll(MemoryPool<Block>& pool)
+    {
+        std::set<Block*> seen;
+        while (Block* block = pool.allocate())
+            if (!seen.insert(block).second) ADD_FAILURE() << "block handed out twice";
+        return seen.size();
+    }
+}
+
+TEST(MemoryPoolTest, CarvesLazilyUpToCapacity)
+{
+    // 1 GB of address space; only the pages actually handed out get touched.
+    MemoryPool<Block> big(std::size_t(1) << 26);
+    Block* first = big.allocate();
+    ASSERT_NE(first, nullptr);
+    big.deallocate(first);
+    EXPECT_EQ(big.allocate(), first);
+
+    for (bool threadCache : { false, true })
+    {
+        MemoryPool<Block> pool(100, PoolOptions { .thread_cache = threadCache });
+        EXPECT_EQ(DrainAll(pool), 100);
+    }
+}
+
+TEST(MemoryPoolTest, ExitingThreadsReturnTheirMagazines)
+{
+    constexpr std::size_t Capacity = 1000;
+    MemoryPool<Block> pool(Capacity);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&pool]
+        {
+            std::vector<Block*> held;
+            for (int i = 0; i < 100; ++i) held.push_back(pool.allocate());
+            for (Block* block : held) pool.deallocate(block);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(DrainAll(pool), Capacity);
+}
+
+TEST(MemoryPoolTest, ConcurrentChurnNeverSharesABlock)
+{
+    constexpr std::size_t Capacity = 4096;
+    constexpr int Threads = 4;
+    MemoryPool<Block> pool(Capacity);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < Threads; ++t)
+    {
+        threads.emplace_back([&pool, t]
+        {
+            std::vector<Block*> held;
+            for (std::uint64_t i = 0; i < 200000; ++i)
+            {
+                // Hold a varying number of blocks so magazines both refill and spill.
+                if (held.size() < 1 + i % 300)
+                {
+                    Block* block = pool.allocate();
+                    ASSERT_NE(block, nullptr);
+                    *block = { static_cast<std::uint64_t>(t), i };
+                    held.push_back(block);
+                }
+                else
+                {
+                    Block* block = held.back();
+                    held.pop_back();
+                    ASSERT_EQ(block->owner, static_cast<std::uint64_t>(t));
+                    pool.deallocate(block);
+                }
+            }
+            for (Block* block : held) pool.deallocate(block);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(DrainAll(pool), Capacity);
+}
+
+TEST(MemoryPoolTest, FixedPoolCountsExhaustion)
+{
+    MemoryPool<Block> pool(64);
+    std::vector<Block*> held;
+    for (int i = 0; i < 64; ++i) held.push_back(pool.allocate());
+    EXPECT_EQ(pool.allocate(), nullptr);
+    EXPECT_EQ(pool.allocate(), nullptr);
+
+    PoolStats stats = pool.Stats();
+    EXPECT_EQ(stats.live, 64);
+    EXPECT_EQ(stats.chunks, 1);
+    EXPECT_EQ(stats.exhausted, 2);
+
+    for (Block* block : held) pool.deallocate(block);
+    EXPECT_EQ(pool.Stats().live, 0);
+    EXPECT_EQ(pool.Stats().high_water, 64);
+}
+
+TEST(MemoryPoolTest, GrowsByChunksAndReleasesIdleOnes)
+{
+    MemoryPool<Block> pool(100, PoolOptions { .growable = true });
+    std::vector<Block*> held;
+    for (std::uint64_t i = 0; i < 350; ++i)
+    {
+        Block* block = pool.allocate();
+        ASSERT_NE(block, nullptr);
+        *block = { 0, i };
+        held.push_back(block);
+    }
+    // Growing never moves a live block.
+    for (std::uint64_t i = 0; i < held.size(); ++i) EXPECT_EQ(held[i]->sequence, i);
+
+    PoolStats stats = pool.Stats();
+    EXPECT_EQ(stats.chunks, 4);
+    EXPECT_EQ(stats.capacity, 400);
+    EXPECT_EQ(stats.live, 350);
+    EXPECT_EQ(stats.exhausted, 0);
+
+    // Free everything but the newest blocks: the first three chunks go idle.
+    for (std::size_t i = 0; i < 300; ++i) pool.deallocate(held[i]);
+    EXPECT_EQ(pool.ReleaseIdleChunks(), 3);
+    stats = pool.Stats();
+    EXPECT_EQ(stats.chunks, 1);
+    EXPECT_EQ(stats.live, 50);
+    EXPECT_GE(stats.high_water, 350);
+
+    // The pool grows again into the freed slots.
+    for (std::size_t i = 300; i < 350; ++i) pool.deallocate(held[i]);
+    held.clear();
+    for (int i = 0; i < 250; ++i) held.push_back(pool.allocate());
+    EXPECT_EQ(pool.Stats().chunks, 3);
+    for (Block* block : held) pool.deallocate(block);
+}
+
+// A thread keeps one magazine per pool it uses. Switching between pools must
+// not hand a magazine back to its pool's shared list: that costs a lock and a
+// spill on every switch, for any two pools whose ids collide in a small table.
+TEST(MemoryPoolTest, SwitchingPoolsKeepsEachMagazine)
+{
+    constexpr std::size_t Capacity = 32;
+    // Ids are consecutive here, so the first and last pools are 64 ids apart.
+    std::vector<std::unique_ptr<MemoryPool<Block>>> pools;
+    for (int i = 0; i < 65; ++i) pools.push_back(std::make_unique<MemoryPool<Block>>(Capacity));
+    MemoryPool<Block>& first = *pools.front();
+    MemoryPool<Block>& last = *pools.back();
+
+    std::vector<Block*> held;
+    for (int round = 0; round < 10; ++round)
+    {
+        held.push_back(first.allocate());
+        held.push_back(last.allocate());
+        ASSERT_NE(held.back(), nullptr);
+    }
+    // Enough other pools to make the thread's table grow.
+    for (auto& pool : pools) pool->deallocate(pool->allocate());
+    held.push_back(first.allocate());
+    held.push_back(last.allocate());
+
+    // Every block not handed out is still in this thread's magazines, so none
+    // is left on the shared lists for another thread.
+    Block* stolen[2] {};
+    std::thread([&] { stolen[0] = first.allocate(); stolen[1] = last.allocate(); }).join();
+    EXPECT_EQ(stolen[0], nullptr);
+    EXPECT_EQ(stolen[1], nullptr);
+    EXPECT_EQ(first.Stats().live, 11);
+    EXPECT_EQ(last.Stats().live, 11);
+
+    for (std::size_t i = 0; i < held.size(); ++i) (i % 2 == 0 ? first : last).deallocate(held[i]);
+}
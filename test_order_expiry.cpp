@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+#include "OrderExpiry.h"
+#include "Order.h"
+
+namespace
+{
+    Timestamp AtTick(std::int64_t tick) { return Timestamp { std::chrono::nanoseconds { tick * OrderExpiry::TickNanos } }; }
+}
+
+TEST(OrderExpiryTest, ExpiresEachOrderOnceItsTickPasses)
+{
+    Order early(OrderType::GoodTillTime, 1, Side::Buy, 100, 10);
+    Order late(OrderType::GoodTillTime, 2, Side::Buy, 100, 10);
+    OrderExpiry expiry;
+    expiry.Advance(AtTick(1000), [](OrderPointer) {});
+    // Deadlines round up to the next tick.
+    expiry.Schedule(&early, AtTick(1005) - std::chrono::nanoseconds { 1 });
+    const OrderExpiry::Handle handle = expiry.Schedule(&late, AtTick(1000 + 64 * 64 * 3));
+    EXPECT_EQ(expiry.DeadlineOf(handle), AtTick(1000 + 64 * 64 * 3));
+    EXPECT_LE(expiry.NextDue(), AtTick(1005));
+
+    std::vector<OrderId> expired;
+    auto collect = [&expired](OrderPointer order) { expired.push_back(order->GetOrderId()); };
+    expiry.Advance(AtTick(1004), collect);
+    EXPECT_TRUE(expired.empty());
+    expiry.Advance(AtTick(1005), collect);
+    ASSERT_EQ(expired.size(), 1);
+    EXPECT_EQ(expired[0], 1);
+
+    expiry.Advance(AtTick(1000 + 64 * 64 * 3 - 1), collect);
+    EXPECT_EQ(expired.size(), 1);
+    expiry.Advance(AtTick(1000 + 64 * 64 * 3), collect);
+    EXPECT_EQ(expired.size(), 2);
+    EXPECT_EQ(expiry.Size(), 0);
+    EXPECT_EQ(expiry.NextDue(), Timestamp::max());
+}
+
+TEST(OrderExpiryTest, CloseSessionTakesOnlyGoodForDayOrders)
+{
+    Order day(OrderType::GoodForDay, 1, Side::Buy, 100, 10);
+    Order timed(OrderType::GoodTillTime, 2, Side::Sell, 101, 10);
+    Order cancelled(OrderType::GoodForDay, 3, Side::Buy, 99, 10);
+    OrderExpiry expiry;
+    expiry.AddToSession(&day);
+    expiry.Schedule(&timed, AtTick(50));
+    expiry.Remove(expiry.AddToSession(&cancelled));
+    EXPECT_EQ(expiry.DeadlineOf(expiry.AddToSession(&cancelled)), Timestamp {});
+
+    std::vector<OrderId> expired;
+    expiry.CloseSession([&expired](OrderPointer order) { expired.push_back(order->GetOrderId()); });
+    EXPECT_EQ(expired, (std::vector<OrderId> { 3, 1 }));
+    EXPECT_EQ(expiry.Size(), 1);
+}
+
+// Against a sorted reference, through removals, long idle gaps and deadlines
+// on every level of the wheel: each advance hands over exactly the orders due.
+TEST(OrderExpiryTest, AgreesWithASortedReference)
+{
+    constexpr int Orders = 2000;
+    std::vector<Order> orders;
+    orders.reserve(Orders);
+    for (int i = 0; i < Orders; ++i) orders.emplace_back(OrderType::GoodTillTime, i, Side::Buy, 100, 10);
+
+    OrderExpiry expiry;
+    std::multimap<std::int64_t, OrderId> reference;
+    std::vector<OrderExpiry::Handle> handles(Orders);
+    std::vector<std::int64_t> deadlines(Orders, -1);
+    std::mt19937_64 rng(11);
+    std::int64_t now = 1'700'000'000'000;
+    expiry.Advance(AtTick(now), [](OrderPointer) { FAIL(); });
+
+    int next = 0;
+    for (int step = 0; step < 20000; ++step)
+    {
+        const auto roll = rng() % 10;
+        if (roll < 4 && next < Orders)
+        {
+            // Spans from the next tick to days out, so every level gets used.
+            const std::int64_t deadline = now + 1 + static_cast<std::int64_t>(rng() % (std::uint64_t { 1 } << (rng() % 38)));
+            handles[next] = expiry.Schedule(&orders[next], AtTick(deadline));
+            deadlines[next] = deadline;
+            reference.emplace(deadline, next++);
+        }
+        else if (roll < 6 && next > 0)
+        {
+            const auto victim = static_cast<int>(rng() % next);
+            if (deadlines[victim] < 0) continue;
+            expiry.Remove(handles[victim]);
+            for (auto [it, end] = reference.equal_range(deadlines[victim]); it != end; ++it)
+            {
+                if (it->second != static_cast<OrderId>(victim)) continue;
+                reference.erase(it);
+                break;
+            }
+            deadlines[victim] = -1;
+        }
+        else
+        {
+            now += roll == 9 ? static_cast<std::int64_t>(rng() % 100'000'000) : static_cast<std::int64_t>(rng() % 2000);
+            std::multiset<OrderId> expected;
+            while (!reference.empty() && reference.begin()->first <= now)
+            {
+                expected.insert(reference.begin()->second);
+                reference.erase(reference.begin());
+            }
+            std::multiset<OrderId> expired;
+            expiry.Advance(AtTick(now), [&](OrderPointer order)
+            {
+                expired.insert(order->GetOrderId());
+                deadlines[order->GetOrderId()] = -1;
+            });
+            ASSERT_EQ(expired, expected) << "step " << step;
+        }
+        ASSERT_EQ(expiry.Size(), reference.size());
+        const Timestamp due = reference.empty() ? Timestamp::max() : AtTick(reference.begin()->first);
+        ASSERT_LE(expiry.NextDue(), due) << "step " << step;
+        ASSERT_GT(expiry.NextDue(), AtTick(now)) << "step " << step;
+    }
+}
@@ -3,6 +3,8 @@
 #include "Order.h"
 #include "OrderType.h"
 #include "FixedSizePool.h" 
+#include <memory>
+#include <random>
 
 class OrderBookTest : public ::testing::Test 
 {
@@ -49,6 +51,16 @@ TEST_F(OrderBookTest, CancelsOrderCorrectly)
     EXPECT_TRUE(infos.GetBids().empty());
 }
 
+TEST_F(OrderBookTest, IgnoresTheReservedOrderId)
+{
+    book->AddOrder(CreateOrder(1, Side::Buy, 150, 100));
+    book->CancelOrder(ReservedOrderId);
+    book->ModifyOrder(OrderModify(ReservedOrderId, Side::Buy, 151, 10));
+    EXPECT_TRUE(book->AddOrder(CreateOrder(ReservedOrderId, Side::Sell, 150, 40)).empty());
+    EXPECT_EQ(book->Size(), 1);
+    EXPECT_EQ(book->GetOrderInfos().GetBids()[0].quantity_, 100);
+}
+
 TEST_F(OrderBookTest, EnforcesPricePriority) 
 {
     book->AddOrder(CreateOrder(1, Side::Buy, 150, 100)); 
@@ -91,4 +103,375 @@ TEST_F(OrderBookTest, WalksTheBook)
 
     EXPECT_EQ(trades.size(), 2);
     EXPECT_EQ(book->Size(), 0);
-}
\ No newline at end of file
+}
+
+class LadderOrderBookTest : public OrderBookTest
+{
+protected:
+    void SetUp() override {
+        pool = new MemoryPool<Order>(1000);
+        book = new OrderBook(*pool, false, LevelStorage::Ladder);
+    }
+};
+
+TEST_F(LadderOrderBookTest, WalksTheBook)
+{
+    book->AddOrder(CreateOrder(1, Side::Sell, 150, 100));
+    book->AddOrder(CreateOrder(2, Side::Sell, 151, 100));
+
+    auto trades = book->AddOrder(CreateOrder(3, Side::Buy, 155, 200));
+
+    EXPECT_EQ(trades.size(), 2);
+    EXPECT_EQ(book->Size(), 0);
+}
+
+TEST_F(LadderOrderBookTest, RecentersAroundDistantPrices)
+{
+    book->AddOrder(CreateOrder(1, Side::Buy, 150, 100));
+    book->AddOrder(CreateOrder(2, Side::Buy, 20000, 100));
+    book->AddOrder(CreateOrder(3, Side::Buy, -20000, 100));
+
+    auto infos = book->GetOrderInfos();
+    ASSERT_EQ(infos.GetBids().size(), 3);
+    EXPECT_EQ(infos.GetBids()[0].price_, 20000);
+    EXPECT_EQ(infos.GetBids()[1].price_, 150);
+    EXPECT_EQ(infos.GetBids()[2].price_, -20000);
+}
+
+// A price whose level would stretch the ladder past MaxTicks is rejected
+// before it can trade, rather than thrown out of AddOrder after it has.
+TEST(LadderBandTest, RejectsOrdersOutsideTheLadderBand)
+{
+    MemoryPool<Order> pool(16);
+    OrderBook book(pool, true, LevelStorage::Ladder, Concurrency::SingleWriter);
+    book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillCancel, 1, Side::Buy, 5'000'000, 10));
+    EXPECT_NO_THROW(book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillCancel, 2, Side::Buy, -2'000'000'000, 10)));
+    // Marketable against the bid, but its remainder could not rest among the asks.
+    book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillCancel, 3, Side::Sell, 5'000'100, 10));
+    EXPECT_TRUE(book.AddOrder(new(pool.allocate()) Order(OrderType::GoodTillCancel, 4, Side::Sell, -2'000'000'000, 20)).empty());
+    EXPECT_EQ(book.Size(), 2);
+    EXPECT_EQ(pool.Stats().live, 2);
+
+    // Orders that never rest may still take the book at any price.
+    EXPECT_EQ(book.AddOrder(new(pool.allocate()) Order(OrderType::FillAndKill, 5, Side::Sell, -2'000'000'000, 20)).size(), 1);
+    EXPECT_EQ(book.Size(), 1);
+    EXPECT_EQ(pool.Stats().live, 1);
+}
+
+TEST_F(LadderOrderBookTest, AdvancesBestPriceAfterLevelEmpties)
+{
+    book->AddOrder(CreateOrder(1, Side::Sell, 150, 100));
+    book->AddOrder(CreateOrder(2, Side::Sell, 420, 100));
+    book->CancelOrder(1);
+
+    auto trades = book->AddOrder(CreateOrder(3, Side::Buy, 419, 100));
+    EXPECT_TRUE(trades.empty());
+
+    trades = book->AddOrder(CreateOrder(4, Side::Buy, 420, 100));
+    EXPECT_EQ(trades.size(), 1);
+    EXPECT_EQ(book->Size(), 1);
+}
+
+class SingleWriterOrderBookTest : public OrderBookTest
+{
+protected:
+    void SetUp() override {
+        pool = new MemoryPool<Order>(1000);
+        book = new OrderBook(*pool, false, LevelStorage::Ladder, Concurrency::SingleWriter);
+    }
+};
+
+TEST_F(SingleWriterOrderBookTest, PublishesSizeAndView)
+{
+    book->AddOrder(CreateOrder(1, Side::Buy, 150, 100));
+    book->AddOrder(CreateOrder(2, Side::Buy, 149, 50));
+    book->AddOrder(CreateOrder(3, Side::Sell, 152, 70));
+    EXPECT_EQ(book->Size(), 3);
+
+    book->PublishView();
+    BookView view = book->GetView();
+    EXPECT_EQ(view.orders_, 3);
+    ASSERT_EQ(view.bidLevels_, 2);
+    ASSERT_EQ(view.askLevels_, 1);
+    EXPECT_EQ(view.bids_[0].price_, 150);
+    EXPECT_EQ(view.bids_[1].quantity_, 50);
+    EXPECT_EQ(view.asks_[0].price_, 152);
+}
+
+TEST_F(SingleWriterOrderBookTest, ModifyReplacesOrderInOnePass)
+{
+    book->AddOrder(CreateOrder(1, Side::Buy, 150, 100));
+    book->AddOrder(CreateOrder(2, Side::Sell, 155, 100));
+
+    auto trades = book->ModifyOrder(OrderModify(1, Side::Buy, 155, 40));
+    EXPECT_EQ(trades.size(), 1);
+    EXPECT_EQ(book->Size(), 1);
+}
+
+TEST_F(SingleWriterOrderBookTest, CancelsGoodForDayOrdersOnRequest)
+{
+    book->AddOrder(new Order(OrderType::GoodForDay, 1, Side::Buy, 150, 100));
+    book->AddOrder(CreateOrder(2, Side::Buy, 149, 100));
+
+    book->CancelGoodForDayOrders();
+    EXPECT_EQ(book->Size(), 1);
+}
+
+TEST_F(SingleWriterOrderBookTest, ExpiresGoodTillTimeOrdersAtTheirDeadlines)
+{
+    using namespace std::chrono;
+    const Timestamp open = sys_days { year { 2026 } / 3 / 2 } + hours { 9 };
+    book->ExpireOrders(open);
+    book->AddOrder(new Order(OrderType::GoodTillTime, 1, Side::Buy, 150, 100), open + milliseconds { 5 });
+    book->AddOrder(new Order(OrderType::GoodTillTime, 2, Side::Buy, 149, 100), open + hours { 2 });
+    book->AddOrder(new Order(OrderType::GoodTillTime, 3, Side::Sell, 155, 100), open + minutes { 1 });
+    // Already due, or with no deadline at all: rejected.
+    book->AddOrder(new Order(OrderType::GoodTillTime, 4, Side::Sell, 156, 100), open);
+    book->AddOrder(new Order(OrderType::GoodTillTime, 5, Side::Sell, 156, 100));
+    book->AddOrder(CreateOrder(6, Side::Buy, 148, 100));
+    EXPECT_EQ(book->Size(), 4);
+    EXPECT_LE(book->NextExpiry(), open + milliseconds { 5 });
+
+    book->ExpireOrders(open + milliseconds { 4 });
+    EXPECT_EQ(book->Size(), 4);
+    book->ExpireOrders(open + milliseconds { 5 });
+    EXPECT_EQ(book->Size(), 3);
+
+    // A cancelled order leaves the index; a modified one keeps its deadline.
+    book->CancelOrder(3);
+    book->ModifyOrder(OrderModify(2, Side::Buy, 147, 50));
+    book->ExpireOrders(open + hours { 2 } - milliseconds { 1 });
+    EXPECT_EQ(book->Size(), 2);
+    book->ExpireOrders(open + hours { 2 });
+    EXPECT_EQ(book->Size(), 1);
+    EXPECT_EQ(book->NextExpiry(), Timestamp::max());
+    EXPECT_EQ(book->GetOrderInfos().GetBids()[0].price_, 148);
+}
+
+TEST_F(SingleWriterOrderBookTest, TradedTimedOrdersLeaveTheExpiryIndex)
+{
+    using namespace std::chrono;
+    const Timestamp open = sys_days { year { 2026 } / 3 / 2 } + hours { 9 };
+    book->ExpireOrders(open);
+    book->AddOrder(new Order(OrderType::GoodTillTime, 1, Side::Sell, 150, 30), open + seconds { 1 });
+    book->AddOrder(new Order(OrderType::GoodForDay, 2, Side::Sell, 150, 30));
+    book->AddOrder(new Order(OrderType::GoodTillTime, 3, Side::Sell, 151, 30), open + seconds { 1 });
+    // Takes the whole first level and part of the second.
+    EXPECT_EQ(book->AddOrder(CreateOrder(4, Side::Buy, 151, 70)).size(), 3);
+    EXPECT_EQ(book->Size(), 1);
+
+    book->CancelGoodForDayOrders();
+    book->ExpireOrders(open + seconds { 1 });
+    EXPECT_EQ(book->Size(), 0);
+}
+
+TEST_F(LadderOrderBookTest, GoodForDayCloseKeepsFillOrKillDepth)
+{
+    book->AddOrder(new Order(OrderType::GoodForDay, 1, Side::Sell, 150, 40));
+    book->AddOrder(CreateOrder(2, Side::Sell, 150, 30));
+    book->AddOrder(new Order(OrderType::GoodForDay, 3, Side::Sell, 151, 40));
+    book->AddOrder(CreateOrder(4, Side::Sell, 152, 20));
+    book->CancelGoodForDayOrders();
+    EXPECT_EQ(book->Size(), 2);
+
+    EXPECT_TRUE(book->AddOrder(new Order(OrderType::FillOrKill, 5, Side::Buy, 152, 51)).empty());
+    EXPECT_EQ(book->AddOrder(new Order(OrderType::FillOrKill, 6, Side::Buy, 152, 50)).size(), 2);
+    EXPECT_EQ(book->Size(), 0);
+}
+
+TEST_F(SingleWriterOrderBookTest, HandsExecutionsToSinks)
+{
+    book->AddOrder(CreateOrder(1, Side::Sell, 150, 30));
+    book->AddOrder(CreateOrder(2, Side::Sell, 151, 30));
+
+    auto ring = std::make_unique<TradeRing>();
+    book->AddOrder(CreateOrder(3, Side::Buy, 151, 50), TradeRingSink { *ring });
+    Trade trade;
+    ASSERT_EQ(ring->try_pop_n(&trade, 1), 1);
+    EXPECT_EQ(trade.GetAskTrade().orderId_, 1);
+    EXPECT_EQ(trade.GetBidTrade().quantity_, 30);
+    ASSERT_EQ(ring->try_pop_n(&trade, 1), 1);
+    EXPECT_EQ(trade.GetAskTrade().orderId_, 2);
+    EXPECT_EQ(trade.GetBidTrade().quantity_, 20);
+    EXPECT_EQ(ring->try_pop_n(&trade, 1), 0);
+
+    Quantity filled = 0;
+    auto sumFills = [&filled](const Trade& t) { filled += t.GetBidTrade().quantity_; };
+    book->ModifyOrder(OrderModify(2, Side::Sell, 140, 10), TradeCallback { sumFills });
+    EXPECT_EQ(filled, 0);
+    book->AddOrder(CreateOrder(4, Side::Buy, 140, 5), TradeCallback { sumFills });
+    EXPECT_EQ(filled, 5);
+}
+
+TEST(OrderLayoutTest, QueueLinksKeepSideAndType)
+{
+    Order first(OrderType::FillOrKill, 1, Side::Sell, 100, 10);
+    Order middle(OrderType::GoodForDay, 2, Side::Buy, 100, 20);
+    Order last(3, Side::Sell, 30);
+
+    OrderList level;
+    level.push_back(&first);
+    level.push_back(&middle);
+    level.push_back(&last);
+    level.erase(&middle);
+    last.ToGoodTillCancel(101);
+
+    EXPECT_EQ(first.GetOrderType(), OrderType::FillOrKill);
+    EXPECT_EQ(first.GetOrderSide(), Side::Sell);
+    EXPECT_EQ(middle.GetOrderType(), OrderType::GoodForDay);
+    EXPECT_EQ(middle.GetOrderSide(), Side::Buy);
+    EXPECT_EQ(last.GetOrderType(), OrderType::GoodTillCancel);
+    EXPECT_EQ(last.GetOrderSide(), Side::Sell);
+    EXPECT_EQ(level.front(), &first);
+    EXPECT_EQ(level.back(), &last);
+    level.pop_front();
+    EXPECT_EQ(level.front(), &last);
+    EXPECT_EQ(last.GetOrderType(), OrderType::GoodTillCancel);
+}
+
+TEST_F(OrderBookTest, KeepsLevelAggregatesThroughFillsAndCancels)
+{
+    book->AddOrder(CreateOrder(1, Side::Sell, 150, 100));
+    book->AddOrder(CreateOrder(2, Side::Sell, 150, 50));
+    book->AddOrder(CreateOrder(3, Side::Sell, 151, 70));
+    book->AddOrder(CreateOrder(4, Side::Buy, 148, 30));
+    book->AddOrder(CreateOrder(5, Side::Buy, 149, 40));
+
+    book->AddOrder(CreateOrder(6, Side::Buy, 150, 120));
+    book->CancelOrder(3);
+    book->ModifyOrder(OrderModify { 4, Side::Buy, 149, 10 });
+
+    LevelInfos bids, asks;
+    book->GetDepth(1, bids, asks);
+    ASSERT_EQ(bids.size(), 1);
+    ASSERT_EQ(asks.size(), 1);
+    EXPECT_EQ(bids[0].price_, 149);
+    EXPECT_EQ(bids[0].quantity_, 50);
+    EXPECT_EQ(asks[0].price_, 150);
+    EXPECT_EQ(asks[0].quantity_, 30);
+
+    book->GetDepth(8, bids, asks);
+    EXPECT_EQ(bids.size(), 1);
+    EXPECT_EQ(asks.size(), 1);
+}
+
+TEST_F(LadderOrderBookTest, FillOrKillReadsLevelAggregates)
+{
+    book->AddOrder(CreateOrder(1, Side::Sell, 150, 100));
+    book->AddOrder(CreateOrder(2, Side::Sell, 151, 100));
+    book->AddOrder(CreateOrder(3, Side::Buy, 140, 100));
+
+    auto trades = book->AddOrder(new Order(OrderType::FillOrKill, 4, Side::Buy, 150, 150));
+    EXPECT_TRUE(trades.empty());
+    EXPECT_EQ(book->Size(), 3);
+
+    trades = book->AddOrder(new Order(OrderType::FillOrKill, 5, Side::Buy, 151, 150));
+    EXPECT_EQ(trades.size(), 2);
+    auto infos = book->GetOrderInfos();
+    ASSERT_EQ(infos.GetAsks().size(), 1);
+    EXPECT_EQ(infos.GetAsks()[0].quantity_, 50);
+}
+
+TEST_F(LadderOrderBookTest, MarketOrderSweepsLevelsAndDropsTheRest)
+{
+    book->AddOrder(CreateOrder(1, Side::Sell, 150, 10));
+    book->AddOrder(CreateOrder(2, Side::Sell, 150, 20));
+    book->AddOrder(CreateOrder(3, Side::Sell, 152, 30));
+    book->AddOrder(CreateOrder(4, Side::Buy, 140, 5));
+
+    auto trades = book->AddOrder(new Order(5, Side::Buy, 45));
+    ASSERT_EQ(trades.size(), 3);
+    EXPECT_EQ(trades[0].GetAskTrade().orderId_, 1);
+    EXPECT_EQ(trades[1].GetAskTrade().orderId_, 2);
+    EXPECT_EQ(trades[2].GetAskTrade().orderId_, 3);
+    EXPECT_EQ(trades[2].GetAskTrade().quantity_, 15);
+    EXPECT_EQ(trades[2].GetBidTrade().price_, 152);
+    EXPECT_EQ(book->Size(), 2);
+
+    // More than the side holds: it takes the rest and the remainder is dropped, not rested.
+    trades = book->AddOrder(new Order(6, Side::Buy, 100));
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].GetAskTrade().quantity_, 15);
+    EXPECT_EQ(book->Size(), 1);
+    auto infos = book->GetOrderInfos();
+    EXPECT_TRUE(infos.GetAsks().empty());
+    ASSERT_EQ(infos.GetBids().size(), 1);
+    EXPECT_EQ(infos.GetBids()[0].quantity_, 5);
+
+    trades = book->AddOrder(new Order(7, Side::Buy, 10));
+    EXPECT_TRUE(trades.empty());
+    EXPECT_EQ(book->Size(), 1);
+}
+
+TEST(OrderBookSweepTest, MarketableLimitOrdersFreeWhatTheyConsume)
+{
+    MemoryPool<Order> pool(64);
+    OrderBook book(pool, true);
+    auto order = [&pool](OrderType type, OrderId id, Side side, Price price, Quantity quantity)
+    {
+        return new(pool.allocate()) Order(type, id, side, price, quantity);
+    };
+    for (OrderId id = 1; id <= 6; ++id) book.AddOrder(order(OrderType::GoodTillCancel, id, Side::Buy, static_cast<Price>(100 - id / 2), 10));
+
+    // Takes the levels at 100 and 99 whole, stops at 98 and rests its last 5 at its own price.
+    auto trades = book.AddOrder(order(OrderType::GoodTillCancel, 10, Side::Sell, 99, 35));
+    EXPECT_EQ(trades.size(), 3);
+    LevelInfos bids, asks;
+    book.GetDepth(4, bids, asks);
+    ASSERT_EQ(asks.size(), 1);
+    EXPECT_EQ(asks[0].price_, 99);
+    EXPECT_EQ(asks[0].quantity_, 5);
+    ASSERT_EQ(bids.size(), 2);
+    EXPECT_EQ(bids[0].price_, 98);
+
+    trades = book.AddOrder(order(OrderType::FillAndKill, 11, Side::Sell, 90, 40));
+    EXPECT_EQ(trades.size(), 3);
+    EXPECT_EQ(book.Size(), 1);
+    trades = book.AddOrder(order(OrderType::Market, 12, Side::Buy, Constants::InvalidPrice, 50));
+    EXPECT_EQ(trades.size(), 1);
+    EXPECT_EQ(book.Size(), 0);
+    EXPECT_EQ(pool.Stats().live, 0);
+}
+
+// The ladder answers FillOrKill from its depth index and the map by walking its
+// levels; through adds, cancels, sweeps and recenters they must always agree.
+TEST(FillOrKillDepthTest, LadderIndexAgreesWithLevelWalk)
+{
+    MemoryPool<Order> mapPool(4096), ladderPool(4096);
+    OrderBook mapBook(mapPool, true, LevelStorage::Map);
+    OrderBook ladderBook(ladderPool, true, LevelStorage::Ladder);
+    auto add = [&](OrderType type, OrderId id, Side side, Price price, Quantity quantity)
+    {
+        const auto mapTrades = mapBook.AddOrder(new(mapPool.allocate()) Order(type, id, side, price, quantity));
+        const auto ladderTrades = ladderBook.AddOrder(new(ladderPool.allocate()) Order(type, id, side, price, quantity));
+        ASSERT_EQ(mapTrades.size(), ladderTrades.size()) << "order " << id;
+    };
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> action(0, 9), offset(-40, 40), quantity(1, 60);
+    OrderId nextId = 1;
+    for (int step = 0; step < 3000; ++step)
+    {
+        const Side side = rng() % 2 == 0 ? Side::Buy : Side::Sell;
+        const int roll = action(rng);
+        if (roll < 5) add(OrderType::GoodTillCancel, nextId++, side, static_cast<Price>(1000 + offset(rng)), quantity(rng));
+        else if (roll < 8) add(OrderType::FillOrKill, nextId++, side, static_cast<Price>(1000 + offset(rng)), quantity(rng) * 4);
+        else if (roll == 8)
+        {
+            const OrderId victim = 1 + rng() % nextId;
+            mapBook.CancelOrder(victim);
+            ladderBook.CancelOrder(victim);
+        }
+        // A far-off price recenters the ladder window.
+        else add(OrderType::GoodTillCancel, nextId++, side, side == Side::Buy ? 1000 - 3000 - step : 1000 + 3000 + step, quantity(rng));
+        ASSERT_EQ(mapBook.Size(), ladderBook.Size()) << "step " << step;
+    }
+
+    LevelInfos mapBids, mapAsks, ladderBids, ladderAsks;
+    mapBook.GetDepth(1000, mapBids, mapAsks);
+    ladderBook.GetDepth(1000, ladderBids, ladderAsks);
+    ASSERT_EQ(mapBids.size(), ladderBids.size());
+    ASSERT_EQ(mapAsks.size(), ladderAsks.size());
+    for (std::size_t i = 0; i < mapBids.size(); ++i) EXPECT_EQ(mapBids[i].quantity_, ladderBids[i].quantity_);
+    for (std::size_t i = 0; i < mapAsks.size(); ++i) EXPECT_EQ(mapAsks[i].quantity_, ladderAsks[i].quantity_);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "Protocol.h"
+#include "EngineCommand.h"
+
+namespace
+{
+    template <typename Msg>
+    void Append(std::vector<char>& stream, const Msg& msg)
+    {
+        const char* bytes = reinterpret_cast<const char*>(&msg);
+        stream.insert(stream.end(), bytes, bytes + sizeof(msg));
+    }
+}
+
+TEST(ProtocolTest, DecodesMixedFramesAndLeavesSplitFrameForNextRead)
+{
+    NewOrderMsg add {};
+    add.type = MessageType::NewOrder;
+    add.order_id = 1;
+    add.price = 150;
+    add.order_type = 1;
+    CancelOrderMsg cancel {};
+    cancel.type = MessageType::CancelOrder;
+    cancel.order_id = 2;
+    std::memcpy(cancel.symbol, "TSLA", 4);
+    ModifyOrderMsg modify {};
+    modify.type = MessageType::ModifyOrder;
+    modify.order_id = 3;
+    modify.quantity = 7;
+
+    std::vector<char> stream;
+    Append(stream, add);
+    Append(stream, cancel);
+    Append(stream, modify);
+
+    std::vector<EngineCommand> commands;
+    auto collect = [&](const auto& msg) { commands.push_back(ToCommand(msg)); };
+
+    // The modify frame is one byte short, as if split across two reads.
+    const std::size_t consumed = DecodeFrames(stream.data(), stream.size() - 1, collect);
+    EXPECT_EQ(consumed, sizeof(NewOrderMsg) + sizeof(CancelOrderMsg));
+    ASSERT_EQ(commands.size(), 2);
+    EXPECT_EQ(commands[0].type, CommandType::NewOrder);
+    EXPECT_EQ(commands[0].order.order_type, 1);
+    EXPECT_EQ(commands[1].type, CommandType::CancelOrder);
+    EXPECT_EQ(commands[1].order.order_id, 2);
+    EXPECT_EQ(std::memcmp(commands[1].order.symbol, "TSLA", 4), 0);
+
+    EXPECT_EQ(DecodeFrames(stream.data() + consumed, stream.size() - consumed, collect), sizeof(ModifyOrderMsg));
+    ASSERT_EQ(commands.size(), 3);
+    EXPECT_EQ(commands[2].type, CommandType::ModifyOrder);
+    EXPECT_EQ(commands[2].order.quantity, 7);
+}
+
+TEST(ProtocolTest, UnknownTypeByteThrows)
+{
+    const char garbage[4] = { 9, 0, 0, 0 };
+    EXPECT_THROW(DecodeFrames(garbage, sizeof(garbage), [](const auto&) {}), std::runtime_error);
+}
+
+TEST(ProtocolTest, ReassemblesFramesSplitAcrossBuffers)
+{
+    std::vector<char> stream;
+    for (uint64_t id = 1; id <= 30; ++id)
+    {
+        if (id % 3 == 0)
+        {
+            CancelOrderMsg cancel {};
+            cancel.type = MessageType::CancelOrder;
+            cancel.order_id = id;
+            Append(stream, cancel);
+        }
+        else
+        {
+            NewOrderMsg add {};
+            add.type = MessageType::NewOrder;
+            add.order_id = id;
+            add.quantity = static_cast<uint32_t>(id);
+            Append(stream, add);
+        }
+    }
+
+    // Hand the stream over in buffers of 1 to 7 bytes, so frames straddle up to eight of them.
+    FrameReassembler frames;
+    std::vector<EngineCommand> commands;
+    auto collect = [&](const auto& msg) { commands.push_back(ToCommand(msg)); };
+    for (std::size_t offset = 0, chunk = 1; offset < stream.size(); offset += chunk, chunk = chunk % 7 + 1)
+        frames.Consume(stream.data() + offset, std::min(chunk, stream.size() - offset), collect);
+
+    EXPECT_EQ(frames.Carried(), 0);
+    ASSERT_EQ(commands.size(), 30);
+    for (uint64_t id = 1; id <= 30; ++id)
+    {
+        EXPECT_EQ(commands[id - 1].order.order_id, id);
+        EXPECT_EQ(commands[id - 1].type, id % 3 == 0 ? CommandType::CancelOrder : CommandType::NewOrder);
+    }
+    EXPECT_EQ(commands[0].order.quantity, 1);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "SpscRing.h"
+
+TEST(SpscRingTest, PushesAndPopsInBatchesAcrossTheWrap)
+{
+    SpscRing<int, 8> ring;
+    int items[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    int out[8] = {};
+
+    EXPECT_EQ(ring.try_push_n(items, 6), 6);
+    EXPECT_EQ(ring.try_pop_n(out, 4), 4);
+    EXPECT_EQ(out[3], 3);
+
+    // Only 6 of these fit; the ring now wraps around its end.
+    EXPECT_EQ(ring.try_push_n(items, 8), 6);
+    EXPECT_FALSE(ring.try_push(99));
+
+    EXPECT_EQ(ring.try_pop_n(out, 8), 8);
+    EXPECT_EQ(out[0], 4);
+    EXPECT_EQ(out[2], 0);
+    EXPECT_EQ(out[7], 5);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, DrainsEveryProducerInOrder)
+{
+    constexpr int Producers = 4;
+    constexpr int PerProducer = 100000;
+    SpscRingSet<std::uint64_t, 64, 8> rings;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < Producers; ++p)
+    {
+        producers.emplace_back([&rings, p]
+        {
+            auto* ring = rings.Acquire();
+            for (std::uint64_t i = 0; i < PerProducer; ++i)
+            {
+                const std::uint64_t item = (std::uint64_t(p) << 32) | i;
+                while (!ring->try_push(item)) std::this_thread::yield();
+            }
+            rings.Release(ring);
+        });
+    }
+
+    std::uint64_t next[Producers] = {};
+    std::uint64_t batch[16];
+    int received = 0;
+    bool ordered = true;
+    while (received < Producers * PerProducer)
+    {
+        received += rings.Drain(batch, 16, [&](std::uint64_t item)
+        {
+            const auto producer = item >> 32;
+            ordered &= (item & 0xffffffff) == next[producer]++;
+        });
+    }
+    for (auto& producer : producers) producer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(received, Producers * PerProducer);
+}
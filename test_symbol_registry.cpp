@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include "SymbolRegistry.h"
+#include "OrderType.h"
+
+namespace
+{
+    std::unique_ptr<OrderBook> MakeBook(MemoryPool<Order>& pool, SymbolKey)
+    {
+        return std::make_unique<OrderBook>(pool, false);
+    }
+}
+
+TEST(SymbolRegistryTest, RoutesWireSymbolsToTheirOwnBook)
+{
+    SymbolRegistry registry;
+    Instrument& aapl = registry.Add("AAPL", 16, MakeBook);
+    Instrument& tsla = registry.Add("TSLA", 16, MakeBook);
+
+    const char wire[8] = { 'T', 'S', 'L', 'A', 0, 0, 0, 0 };
+    EXPECT_EQ(registry.Find(ToSymbolKey(wire)), &tsla);
+    EXPECT_EQ(registry.Find(ToSymbolKey("AAPL")), &aapl);
+    EXPECT_EQ(registry.Find(ToSymbolKey("MSFT")), nullptr);
+
+    tsla.book_->AddOrder(new Order(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10));
+    EXPECT_EQ(tsla.book_->Size(), 1);
+    EXPECT_EQ(aapl.book_->Size(), 0);
+}
+
+TEST(SymbolRegistryTest, RejectsInvalidAndDuplicateSymbols)
+{
+    SymbolRegistry registry;
+    registry.Add("AAPL", 16, MakeBook);
+
+    EXPECT_THROW(registry.Add("AAPL", 16, MakeBook), std::invalid_argument);
+    EXPECT_THROW(registry.Add("", 16, MakeBook), std::invalid_argument);
+    EXPECT_THROW(registry.Add("TOOLONGSYM", 16, MakeBook), std::invalid_argument);
+    EXPECT_EQ(registry.Size(), 1);
+}
+
+TEST(SymbolRegistryTest, ShardsAreStableAndInRange)
+{
+    for (const char* symbol : { "AAPL", "TSLA", "MSFT", "GOOG", "AMZN", "NVDA" })
+    {
+        const SymbolKey key = ToSymbolKey(symbol);
+        EXPECT_EQ(ShardOf(key, 1), 0);
+        EXPECT_LT(ShardOf(key, 4), 4);
+        EXPECT_EQ(ShardOf(key, 4), ShardOf(key, 4));
+    }
+}
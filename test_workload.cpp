@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "Workload.h"
+
+namespace
+{
+    WorkloadSpec SmallSpec()
+    {
+        WorkloadSpec spec;
+        spec.name_ = "small";
+        spec.seed_ = 42;
+        spec.commands_ = 20000;
+        spec.preload_ = 1000;
+        return spec;
+    }
+}
+
+TEST(WorkloadTest, SameSeedSameStreamAndRatiosHold)
+{
+    const auto first = GenerateWorkload(SmallSpec());
+    const auto second = GenerateWorkload(SmallSpec());
+    ASSERT_EQ(first.size(), 21000);
+    ASSERT_EQ(second.size(), first.size());
+    EXPECT_EQ(std::memcmp(first.data(), second.data(), first.size() * sizeof(EngineCommand)), 0);
+
+    std::size_t cancels = 0;
+    std::uint64_t previous = 0;
+    for (std::size_t i = 1000; i < first.size(); ++i)
+    {
+        cancels += first[i].type == CommandType::CancelOrder;
+        EXPECT_GE(first[i].order.timestamp, previous);
+        previous = first[i].order.timestamp;
+    }
+    // 30% cancels by default, give or take sampling noise.
+    EXPECT_GT(cancels, 5000);
+    EXPECT_LT(cancels, 7000);
+}
+
+TEST(WorkloadTest, RoundTripsThroughAFile)
+{
+    const auto commands = GenerateWorkload(SmallSpec());
+    const std::string path = ::testing::TempDir() + "workload_test.wl";
+    SaveWorkload(path, commands);
+    const auto loaded = LoadWorkload(path);
+    std::remove(path.c_str());
+
+    ASSERT_EQ(loaded.size(), commands.size());
+    EXPECT_EQ(std::memcmp(loaded.data(), commands.data(), commands.size() * sizeof(EngineCommand)), 0);
+    EXPECT_THROW(LoadWorkload(path), std::runtime_error);
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Workload.h"
+
+// Writes the built-in replay scenarios as binary workload files.
+// Usage: ./workload_gen <scenario|all> [--seed=N] [--commands=N] [--out=DIR]
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: ./workload_gen <scenario|all> [--seed=N] [--commands=N] [--out=DIR]\n";
+            std::cerr << "  scenarios:";
+            for (const auto& scenario : BuiltinScenarios()) std::cerr << " " << scenario.name_;
+            std::cerr << "\n";
+            return 1;
+        }
+
+        const std::string wanted = argv[1];
+        std::string directory = ".";
+        std::vector<WorkloadSpec> scenarios = BuiltinScenarios();
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option.starts_with("--seed=")) {
+                for (auto& scenario : scenarios) scenario.seed_ = std::stoull(option.substr(7));
+            } else if (option.starts_with("--commands=")) {
+                for (auto& scenario : scenarios) scenario.commands_ = std::stoull(option.substr(11));
+            } else if (option.starts_with("--out=")) {
+                directory = option.substr(6);
+            } else {
+                std::cerr << "[ERROR] Unknown option '" << option << "'\n";
+                return 1;
+            }
+        }
+
+        bool found = false;
+        for (const auto& scenario : scenarios)
+        {
+            if (wanted != "all" && wanted != scenario.name_) continue;
+            found = true;
+
+            const std::vector<EngineCommand> commands = GenerateWorkload(scenario);
+            const std::string path = directory + "/" + scenario.name_ + ".wl";
+            SaveWorkload(path, commands);
+            std::cout << "[WORKLOAD] " << path << ": " << commands.size() << " commands ("
+                      << scenario.preload_ << " preloaded, seed " << scenario.seed_ << ")\n";
+        }
+        if (!found)
+        {
+            std::cerr << "[ERROR] Unknown scenario '" << wanted << "'\n";
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Fatal Exception: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}